@@ -18,6 +18,10 @@
 //------------------------------------------------------------------------------
 #include <NTPtimeESP.h>   //https://github.com/SensorsIot/NTPtimeESP
 //------------------------------------------------------------------------------
+// Libraries for synchronizing several Lichtwecker
+//------------------------------------------------------------------------------
+#include <WiFiUdp.h>
+//------------------------------------------------------------------------------
 // I/O PINS
 //------------------------------------------------------------------------------
 #define DATA_PIN            D4 //NeoPixel LED-Matrix
@@ -35,24 +39,70 @@
 #define MATRIX_WIDTH        8
 #define MATRIX_HEIGHT       8
 #define MATRIX_TYPE         VERTICAL_MATRIX
-#define BRIGHTNESS          20
+#define NUM_LEDS            (MATRIX_WIDTH * MATRIX_HEIGHT)
+#define BRIGHTNESS          20        //Brightness for the clock
+#define BRIGHTNESS_START    2         //Brightness at the start of the Sunrise
+#define BRIGHTNESS_END      80        //Brightness at the end of the fade, 0...255
+#define BRIGHTNESS_CURVE    FADE_EASE_IN
 //------------------------------------------------------------------------------
 // MORE PARAMETERS
 //------------------------------------------------------------------------------
-#define VOLUME              20        //Initial Volume for Mp3 Files, 0...30
+#define VOLUME              20        //Volume at the end of the fade, 0...30
+#define VOLUME_START        5         //Volume at the start of the Sunrise, 0...30
+#define VOLUME_CURVE        FADE_LINEAR
+#define FADE_DURATION       60000     //Time in Miliseconds to fade in light and sound
+#define DFPLAYER_COMMAND_GAP 200      //Minimum time in Miliseconds between volume commands
+#define SUNRISE_STEP_DELAY  1000      //Time in Miliseconds per step of the rising sun
+#define SUNRISE_GLOW_DELAY  100       //Time in Miliseconds per color step of the risen sun
+#define COUNTDOWN_STEP_DELAY 1000     //Time in Miliseconds per number of the Countdown
+#define CROSSFADE_STEP      26        //Blend amount per frame between two phases, 26 = 1 second
+#define API_BODY_SIZE       256       //Maximum size of a request body for the JSON API
+#define API_RESPONSE_SIZE   320       //Maximum size of a response of the JSON API
 #define FPS                 10        //Frames per Second
-#define FPS_DELAY           1000/FPS  //Time in Miliseconds per Frame
+#define FPS_DELAY           (1000/FPS) //Time in Miliseconds per Frame
 #define MAX_COOLDOWN        120       //Amount of Flame Drop, 0...255
+#define MAX_FOLDERS         10        //Folders on the SD-Card to be indexed, 01...10
+#define MAX_TRACKS          255       //Maximum length of the Phase 3 playlist
+#define FIRST_PLAYLIST_TRACK 3        //0001.mp3 is the Sunrise, 0002.mp3 the Countdown
 //------------------------------------------------------------------------------
 // Wi-Fi Settings
 //------------------------------------------------------------------------------
 const char* ssid      = "INSERT_WIFI_SSID"; // Set your WiFi SSID here
 const char* password  = "INSERT_WIFI_PASSWORD"; // Set your WiFi password here
 //------------------------------------------------------------------------------
+// Sync Settings
+//------------------------------------------------------------------------------
+#define SYNC_OFF            0
+#define SYNC_MASTER         1         //sends its wakeupSequence to the other units
+#define SYNC_SLAVE          2         //follows the wakeupSequence of the master
+#ifndef SYNC_MODE
+#define SYNC_MODE           SYNC_OFF  //Set one unit to SYNC_MASTER and the others to SYNC_SLAVE
+#endif
+#define SYNC_PORT           4210      //UDP Port for the multicast group
+#define SYNC_MAGIC          0x4C574B31 //"LWK1", ignores foreign packets
+#define SYNC_BEACON_INTERVAL 1000     //Time in Miliseconds between two beacons of the master
+#define SYNC_REQUEST_INTERVAL 2000    //Time in Miliseconds between two clock samples of a slave
+#define SYNC_SAMPLES        8         //Clock samples to choose the best offset from
+//------------------------------------------------------------------------------
+// Frame Capture Settings
+//------------------------------------------------------------------------------
+#ifndef FRAME_CAPTURE
+#define FRAME_CAPTURE       0         //1 = records the frames of one phase for GET /api/frames
+#endif
+#ifndef FRAME_CAPTURE_PHASE
+#define FRAME_CAPTURE_PHASE PHASE_FIRE //Phase to be recorded, PHASE_IDLE records the clock
+#endif
+#ifndef FRAME_CAPTURE_SIZE
+#define FRAME_CAPTURE_SIZE  16384     //Bytes for the frame log, recording stops when full, max. 65535
+#endif
+#define FRAME_CAPTURE_SEED  1         //Seed of the fire, same seed = same flames
+//------------------------------------------------------------------------------
 // Alarm Settings
 //------------------------------------------------------------------------------
 uint8_t alarmHour = 16;     //Set your default Alarm-Time Here
 uint8_t alarmMinute = 58;   //Set your default Alarm-Time Here
+uint8_t alarmFolder = 0;    //Playlist for Phase 3, 0 = every song on the SD-Card
+bool alarmShuffle = false;  //Plays the playlist in random order
 //------------------------------------------------------------------------------
 // Objects
 //------------------------------------------------------------------------------
@@ -63,9 +113,64 @@ cLEDText ScrollingMsg; //to sroll the time and display the countdown
 NTPtime NTPde("0.de.pool.ntp.org"); //Choosing a german server pool
 strDateTime dateTime; //stores date from NTP-Server
 WiFiServer server(80); //for the HTML WebInterace
+#if SYNC_MODE != SYNC_OFF
+WiFiUDP syncUdp; //for the Sync between several units
+IPAddress syncGroup(239, 76, 87, 75); //Multicast group of the units
+#endif
 //------------------------------------------------------------------------------
 // Variables
 //------------------------------------------------------------------------------
+enum WakeupPhase {
+  PHASE_IDLE,       //no alarm
+  PHASE_SUNRISE,    //Phase 1
+  PHASE_COUNTDOWN,  //Phase 2
+  PHASE_FIRE        //Phase 3
+};
+
+enum SyncPacketType {
+  SYNC_BEACON,      //master -> group: state of the wakeupSequence
+  SYNC_REQUEST,     //slave -> master: clock sample request
+  SYNC_RESPONSE     //master -> slave: clock sample
+};
+
+/*
+Small enough for a single frame, every unit is a NodeMCU so no byte order
+conversion is necessary. t1...t3 are the timestamps of an NTP-like exchange.
+*/
+struct __attribute__((packed)) SyncPacket {
+  uint32_t magic;
+  uint8_t type;
+  uint8_t running;          //wakeupSequence of the master is running
+  uint32_t sequenceStart;   //start of the wakeupSequence in master time
+  uint32_t t1;              //slave time, request sent
+  uint32_t t2;              //master time, request received
+  uint32_t t3;              //master time, response or beacon sent
+};
+
+//everything in /api/state, packed so two states compare with memcmp
+struct __attribute__((packed)) ApiState {
+  uint8_t alarmHour;
+  uint8_t alarmMinute;
+  uint8_t alarmFolder;
+  uint8_t alarmShuffle;
+  uint8_t running;
+  uint8_t music;
+  uint8_t phase;
+  uint16_t trackCount;
+  uint8_t folderCount;
+};
+
+struct SyncSample {
+  int32_t offset;           //master time - slave time
+  uint32_t roundTrip;       //time on the network, without the time in the master
+};
+
+enum FadeCurve {
+  FADE_LINEAR,      //constant change
+  FADE_EASE_IN,     //quadratic, starts slow
+  FADE_EASE_IN_OUT  //starts and ends slow
+};
+
 bool wakeUpProcessStarted = false;
 bool wakeUpProcessStopped = false;
 bool musicStarted = false;
@@ -77,8 +182,20 @@ bool buttonShowTimePressed = false;
 bool timeTextUpdated = false;
 bool countdownFinished = false;
 bool countdownAnimationFinished = false;
+bool trackIndexDirty = false;  //SD-Card changed, index is refreshed after the alarm
+bool sequenceStarted = false;
+bool syncLocked = false;      //slave knows the clock offset and follows the master
+bool syncMasterRunning = false; //last state received from the master
+bool syncMasterKnown = false; //a beacon of the master was received
+
+uint16_t trackCount = 0;      //Songs on the SD-Card, cached at boot
+uint8_t folderCount = 0;      //Folders on the SD-Card, cached at boot
+uint8_t folderTrackCounts[MAX_FOLDERS + 1]; //Songs per folder, index 0 is unused
+uint16_t playlist[MAX_TRACKS];  //Track numbers for Phase 3
+uint8_t playlistLength = 0;   //0 = playlist has to be built
+uint8_t playlistPosition = 0; //next entry of the playlist to be played
+uint8_t playlistFolder = 0;   //Folder of the playlist, 0 = root
 
-uint8_t songCounter = 0;      //Song counter for diagnostics
 uint8_t currentNumber = 10;   //Countdown, start out at 10
 uint8_t currentHour = 0;      //for the Clock
 uint8_t currentMinute = 0;    //for the Clock
@@ -86,6 +203,36 @@ uint8_t currentSecond = 0;    //for the Clock
 int8_t sunposition = -6;      //Start outside the view field
 uint8_t heatIndex = 0;        //Color of the sun
 
+uint32_t sequenceStartTime = 0; //millis() when the alarm started
+uint32_t frameCounter = 0;    //frames shown by the loop
+uint32_t sequenceStartFrame = 0; //frameCounter when the alarm started
+uint32_t countdownStepTime = 0; //time on the timeline of the last number of the Countdown
+uint32_t syncSequenceStart = 0; //start of the wakeupSequence in master time
+int32_t syncOffset = 0;       //master time - own time
+uint32_t syncRoundTrip = 0;   //round trip time of the best sample
+SyncSample syncSamples[SYNC_SAMPLES];
+uint8_t syncSampleCount = 0;
+uint8_t syncSampleIndex = 0;
+IPAddress syncMasterIP;       //learned from the beacons
+uint8_t fadeVolume = VOLUME_START;  //Volume requested by the fade
+uint8_t sentVolume = VOLUME_START;  //Volume last sent to the DFPlayer
+uint32_t lastDFPlayerCommand = 0;   //millis() of the last command to the DFPlayer
+CRGB effectFrame[NUM_LEDS];   //off-screen canvas of the current effect
+CRGB fadeFrame[NUM_LEDS];     //last frame of the previous phase
+uint8_t crossfade = 255;      //progress of the crossfade, 255 = finished
+WakeupPhase renderedPhase = PHASE_IDLE; //phase of the effect in effectFrame
+uint32_t effectRenderMicros = 0; //duration of the last frame of the effect pipeline
+
+#if FRAME_CAPTURE
+uint8_t captureLog[FRAME_CAPTURE_SIZE]; //frame log, see captureFrame()
+uint16_t captureLength = 0;   //used bytes of captureLog
+CRGB capturedFrame[NUM_LEDS]; //last recorded frame, the next one is stored as difference
+uint8_t capturedBrightness = 0;
+#endif
+
+uint32_t stateVersion = 0;    //ETag of /api/state, counts every change of the state
+ApiState publishedState;      //state of the current stateVersion
+
 char timeTxt[] = "23:59:59";  //init Time
 String readString = "";       //For the HTTP Request
 //------------------------------------------------------------------------------
@@ -98,18 +245,38 @@ void setupDFPlayer(); //initializes the Mp3 Module
 void setupLEDMatrix(); //initializes the LED-Matrix
 void setupLEDText(); //sets Font and Color for the LED-Text to be displayed
 void setupDigitalInputPins(); //sets pinMode for every I/O Pin
+void readTrackIndex(); //reads the track and folder counts from the DFPlayer
 
 void readInputPins(); //reads digital Input Pins and sets variables accordingly
 void checkAlarmTime(); //checks if current time is alarm time and starts alarm
+void checkDFPlayerCard(); //refreshes the track index when the SD-Card changes
 
 void controlShowTimeSequence(); //displays the time, when button is pressed
 void controlWakeupSequence(); //controls the states when alarm is started
+WakeupPhase currentWakeupPhase(); //derives the phase from the states
+void renderWakeupEffect(WakeupPhase phase); //renders the effect of a phase with crossfade
+void startFrameCapture(); //empties the frame log
+void captureFrame(); //adds the frame on the matrix to the frame log
+void showFrame(); //records and shows the frame, counts the frames
 void stopWakeUpProcess(); //stops the wakeupSequence
+void controlSequenceTimeline(); //starts the timeline of the wakeupSequence
+uint32_t sequenceMillis(); //time since the start of the wakeupSequence
+uint16_t mixFrame(uint32_t frame); //turns a frame number into a seed for the fire
+void controlFade(); //fades in brightness and volume during the wakeupSequence
+void updateDFPlayerVolume(); //sends the faded volume, at most once per DFPLAYER_COMMAND_GAP
+uint8_t applyFadeCurve(uint8_t progress, FadeCurve curve); //shapes the fade
 void controlWebsite(); //Builds a website when a client connects
+void controlApi(WiFiClient &client, String &request); //answers the JSON API
+void sendApiResponse(WiFiClient &client, const char *status, const char *body, int length); //writes a JSON response
+void sendApiState(WiFiClient &client, bool notModified); //writes the state as JSON
+int8_t readJsonValue(const char *json, const char *key, int &value); //reads a number from a JSON object
+uint32_t updateStateVersion(); //increases the version when the state changed
+const char* wakeupPhaseName(); //name of the current phase for the API
 
 void playFirstSong(); //Plays the first song on the SD-Card, 0001.mp3
 void playCountDown(); //Plays the second song on the SD-Card, 0002.mp3
 void playNextSongWhenFinished(); //Plays every song on the SD-Card
+void buildPlaylist(); //Fills the playlist for Phase 3 from the track index
 
 void showSunrise(); //shows a rising sun on the LED-Matrix
 void showCountdown(); //shows a Countdown from 10 to 1 on the LED-Matrix
@@ -118,9 +285,74 @@ void showTime(); //shows the time on the LED-matrix
 void movingDot();//shows a moving red dot on the LED-Matrix
 void drawSun(int16_t xc, int16_t yc, uint16_t r, CRGB Col); //draws a filled circle
 
+void setupSync(); //joins the multicast group of the units
+void controlSync(); //sends and receives the sync packets, never blocks
+void sendSyncPacket(SyncPacket &packet, IPAddress ip, uint16_t port); //sends a single packet
+void handleSyncPacket(SyncPacket &packet); //reacts to a received packet
+void addSyncSample(uint32_t t1, uint32_t t2, uint32_t t3, uint32_t t4); //estimates the clock offset
+void resetSyncSamples(); //forgets the clock samples of the last master
+
 void updateTime(); //Gets current time from an NTP Server
 void updateTimeText(); //Updates the time to be displayed on the LED-matrix
 //------------------------------------------------------------------------------
+// Effects
+//------------------------------------------------------------------------------
+/*
+Every effect draws one frame into leds with draw(). Effect<> only casts to the
+effect itself, so render() compiles to a direct call without virtual
+functions. New effects are added to WakeupEffects in the order of WakeupPhase.
+*/
+template <typename T>
+class Effect {
+  public:
+    void render(){ static_cast<T*>(this)->draw(); }
+};
+
+class NoEffect : public Effect<NoEffect> {
+  public:
+    void draw(){ FastLED.clear(); }
+};
+
+class SunriseEffect : public Effect<SunriseEffect> {
+  public:
+    void draw(){ showSunrise(); }
+};
+
+class CountdownEffect : public Effect<CountdownEffect> {
+  public:
+    void draw(){ showCountdown(); }
+};
+
+class FireEffect : public Effect<FireEffect> {
+  public:
+    void draw(){ showFireAnimation(); }
+};
+
+/*
+Registry of the effects, resolved at compile time into a chain of
+comparisons. The effects have no members, so nothing is allocated.
+*/
+template <typename... Effects>
+struct EffectRegistry;
+
+template <>
+struct EffectRegistry<> {
+  static void render(uint8_t index){ (void)index; }
+};
+
+template <typename First, typename... Rest>
+struct EffectRegistry<First, Rest...> {
+  static void render(uint8_t index){
+    if(index == 0){
+      First().render();
+    } else {
+      EffectRegistry<Rest...>::render(index - 1);
+    }
+  }
+};
+
+typedef EffectRegistry<NoEffect, SunriseEffect, CountdownEffect, FireEffect> WakeupEffects;
+//------------------------------------------------------------------------------
 // setup
 //------------------------------------------------------------------------------
 void setup(){
@@ -131,6 +363,10 @@ void setup(){
   setupLEDText();
   setupDigitalInputPins();
   setupTime();
+  setupSync();
+#if FRAME_CAPTURE
+  startFrameCapture();
+#endif
   Serial.println(F("Finished Initializing.\n"));
   delay(100);
 }
@@ -186,7 +422,32 @@ void setupDFPlayer(){
     while(true);
   }
   Serial.print(F("done\n"));
-  myDFPlayer.volume(VOLUME);  //Set volume value. From 0 to 30
+  myDFPlayer.volume(VOLUME_START);  //Set volume value. From 0 to 30, faded in by controlFade()
+  sentVolume = VOLUME_START;
+  readTrackIndex();
+}
+
+/*
+Reads the number of songs and folders once from the DFPlayer and keeps them in RAM.
+Every query is a round-trip over the SoftwareSerial, so this must never run
+while the alarm is playing. The index is refreshed by checkDFPlayerCard().
+*/
+void readTrackIndex(){
+  Serial.print(F("Reading track index... "));
+  int files = myDFPlayer.readFileCounts();
+  trackCount = files > 0 ? files : 0;
+  int folders = myDFPlayer.readFolderCounts();
+  folderCount = folders > 0 ? min(folders, MAX_FOLDERS) : 0;
+  folderTrackCounts[0] = 0;
+  for(uint8_t folder = 1; folder <= MAX_FOLDERS; folder++){
+    int count = folder <= folderCount ? myDFPlayer.readFileCountsInFolder(folder) : 0;
+    folderTrackCounts[folder] = count > 0 ? min(count, MAX_TRACKS) : 0;
+  }
+  trackIndexDirty = false;
+  Serial.print(trackCount);
+  Serial.print(F(" songs in "));
+  Serial.print(folderCount);
+  Serial.print(F(" folders\n"));
 }
 
 void setupLEDMatrix(){
@@ -310,70 +571,75 @@ void showCountdownOld(){
   }
 }
 
+/*
+The numbers change on the timeline of the wakeupSequence, so a recording of
+the Countdown does not depend on when the loop runs.
+*/
 void showCountdown(){
-  EVERY_N_SECONDS(1) {
+  uint32_t elapsed = sequenceMillis();
+  if(elapsed - countdownStepTime >= COUNTDOWN_STEP_DELAY){
+    countdownStepTime = elapsed;
     if(currentNumber == 10){
-      FastLED.clear(true);
+      FastLED.clear();
       //Drawing the 10 manually, because text doesnt fit in the Matrix
       leds.DrawLine(1, 0, 1, 7, CRGB::Red);
       leds.DrawRectangle(3, 0, 6, 7, CRGB::Red);
     } else if(currentNumber == 9){
-      FastLED.clear(true);
+      FastLED.clear();
       ScrollingMsg.SetText((unsigned char *)" 9", 2);
       for(int i = 0; i < 6; i++){
         ScrollingMsg.UpdateText();
       }
     } else if(currentNumber == 8){
-      FastLED.clear(true);
+      FastLED.clear();
       ScrollingMsg.SetText((unsigned char *)" 8", 2);
       for(int i = 0; i < 6; i++){
         ScrollingMsg.UpdateText();
       }
     } else if(currentNumber == 7){
-      FastLED.clear(true);
+      FastLED.clear();
       ScrollingMsg.SetText((unsigned char *)" 7", 2);
       for(int i = 0; i < 6; i++){
         ScrollingMsg.UpdateText();
       }
     } else if(currentNumber == 6){
-      FastLED.clear(true);
+      FastLED.clear();
       ScrollingMsg.SetText((unsigned char *)" 6", 2);
       for(int i = 0; i < 6; i++){
         ScrollingMsg.UpdateText();
       }
     } else if(currentNumber == 5){
-      FastLED.clear(true);
+      FastLED.clear();
       ScrollingMsg.SetText((unsigned char *)" 5", 2);
       for(int i = 0; i < 6; i++){
         ScrollingMsg.UpdateText();
       }
     } else if(currentNumber == 4){
-      FastLED.clear(true);
+      FastLED.clear();
       ScrollingMsg.SetText((unsigned char *)" 4", 2);
       for(int i = 0; i < 6; i++){
         ScrollingMsg.UpdateText();
       }
     } else if(currentNumber == 3){
-      FastLED.clear(true);
+      FastLED.clear();
       ScrollingMsg.SetText((unsigned char *)" 3", 2);
       for(int i = 0; i < 6; i++){
         ScrollingMsg.UpdateText();
       }
     } else if(currentNumber == 2){
-      FastLED.clear(true);
+      FastLED.clear();
       ScrollingMsg.SetText((unsigned char *)" 2", 2);
       for(int i = 0; i < 6; i++){
         ScrollingMsg.UpdateText();
       }
     } else if(currentNumber == 1){
-      FastLED.clear(true);
+      FastLED.clear();
       ScrollingMsg.SetText((unsigned char *)" 1", 2);
       for(int i = 0; i < 6; i++){
         ScrollingMsg.UpdateText();
       }
       countdownAnimationFinished = true;
     }
-    FastLED.show();
     if(currentNumber > 1)
       currentNumber--;
   }
@@ -387,10 +653,9 @@ The filename should be 0001.mp3
 void playFirstSong(){
   bool noSongPlaying = digitalRead(BUSY_PIN);
   if (noSongPlaying && !musicStarted) {
-    Serial.print(F("Playing first song... ["));
-    Serial.print(songCounter = 0);  //reset Counter
-    Serial.print(F("]\n"));
+    Serial.print(F("Playing first song... [1]\n"));
     myDFPlayer.play(1);  //Play the first mp3 0001.mp3
+    lastDFPlayerCommand = millis();
     musicStarted = true;
     delay(100);
   } else if (noSongPlaying && musicStarted){
@@ -405,11 +670,11 @@ The filename should be 0002.mp3
 void playCountDown(){
   bool noSongPlaying = digitalRead(BUSY_PIN);
   if (noSongPlaying && firstSongFinished & !countdownStarted) {
-    Serial.print(F("Playing Coutndown... ["));
-    Serial.print(songCounter++);  //reset Counter
-    Serial.print(F("]\n"));
+    Serial.print(F("Playing Coutndown... [2]\n"));
     myDFPlayer.play(2);  //Play the first mp3 0001.mp3
+    lastDFPlayerCommand = millis();
     countdownStarted = true;
+    countdownStepTime = sequenceMillis(); //the 10 follows one step later
     delay(100);
   } else if (noSongPlaying && countdownStarted){
     countdownFinished = true;
@@ -417,15 +682,71 @@ void playCountDown(){
 }
 
 /*
-keeps Playing every Song on the SD-Card until the STOP button is pressed
+Fills the playlist for Phase 3 from the cached track index, so no
+serial query is necessary during the alarm. Uses the folder of the alarm
+if it contains songs, otherwise every song after the Countdown.
+*/
+void buildPlaylist(){
+  uint16_t first = FIRST_PLAYLIST_TRACK;
+  uint16_t last = trackCount;
+  playlistFolder = 0;
+  if(alarmFolder > 0 && alarmFolder <= folderCount && folderTrackCounts[alarmFolder] > 0){
+    playlistFolder = alarmFolder;
+    first = 1;
+    last = folderTrackCounts[alarmFolder];
+  }
+
+  playlistLength = 0;
+  for(uint16_t track = first; track <= last && playlistLength < MAX_TRACKS; track++){
+    playlist[playlistLength++] = track;
+  }
+
+  if(alarmShuffle && playlistLength > 1){
+    //random16 starts with the same seed after every boot
+    random16_set_seed(RANDOM_REG32);
+    //Fisher-Yates shuffle
+    for(uint8_t i = playlistLength - 1; i > 0; i--){
+      uint8_t j = random16(i + 1);
+      uint16_t swap = playlist[i];
+      playlist[i] = playlist[j];
+      playlist[j] = swap;
+    }
+  }
+  playlistPosition = 0;
+}
+
+/*
+keeps Playing the playlist until the STOP button is pressed.
+Starts over (and reshuffles) at the end of the playlist.
 */
 void playNextSongWhenFinished(){
   bool noSongPlaying = digitalRead(BUSY_PIN);
   if (noSongPlaying) {
+    if(playlistPosition >= playlistLength){
+      buildPlaylist();
+    }
+    if(playlistLength == 0){
+      //no track index available, let the DFPlayer choose
+      Serial.print(F("Playing next song... [?]\n"));
+      myDFPlayer.next();
+      lastDFPlayerCommand = millis();
+      delay(100);
+      return;
+    }
+    uint16_t track = playlist[playlistPosition++];
     Serial.print(F("Playing next song... ["));
-    Serial.print(++songCounter);
-    Serial.print(F("]\n"));
-    myDFPlayer.next();
+    if(playlistFolder > 0){
+      Serial.print(playlistFolder);
+      Serial.print(F("/"));
+      Serial.print(track);
+      Serial.print(F("]\n"));
+      myDFPlayer.playFolder(playlistFolder, track);
+    } else {
+      Serial.print(track);
+      Serial.print(F("]\n"));
+      myDFPlayer.play(track);
+    }
+    lastDFPlayerCommand = millis();
     delay(100);
   }
 }
@@ -452,7 +773,12 @@ https://github.com/darrenpmeyer/Arduino-FireBoard
 void showFireAnimation () {
   static uint8_t base_heat[MATRIX_WIDTH];    //1 temperature per Column
   CRGB array[MATRIX_HEIGHT][MATRIX_WIDTH]; //for later mapping to the LED-Matrix
-  random16_add_entropy(random8());
+#if SYNC_MODE != SYNC_OFF || FRAME_CAPTURE
+  //every unit and every recording draws the same flames for the same frame of the timeline
+  random16_set_seed(mixFrame(syncSequenceStart + FRAME_CAPTURE_SEED + sequenceMillis() / FPS_DELAY));
+#else
+  random16_add_entropy(RANDOM_REG32);
+#endif
 
   //new temperature
   for(int i = 0; i < 8; i++){
@@ -486,6 +812,7 @@ void stopWakeUpProcess(){
   if(musicStarted){
     Serial.print(F("Stopping music... "));
     myDFPlayer.stop();
+    lastDFPlayerCommand = millis();
     musicStarted = false; //so next time the first song will be played
     Serial.print(F("done\n"));
     delay(100);
@@ -501,36 +828,135 @@ void stopWakeUpProcess(){
   sunposition = -6;
   heatIndex = 0;
   currentNumber = 10;
+  countdownStepTime = 0;
+  playlistLength = 0; //rebuilt with the settings of the next alarm
+  playlistPosition = 0;
+  sequenceStarted = false;
+  renderedPhase = PHASE_IDLE; //no crossfade, stopping is immediate
+  crossfade = 255;
+  fadeVolume = VOLUME_START; //next alarm starts quiet again
+  FastLED.setBrightness(BRIGHTNESS);
   Serial.println(F("Alarm stopped."));
 }
 
+/*
+The sun is calculated from the timeline of the wakeupSequence instead of
+counting frames, so synchronized units show the same sun at the same time.
+First the sun rises one pixel per step, then it glows from red to white.
+*/
 void showSunrise(){
-  //static int sunposition = -6; //Start outside the view field
-  //static uint8_t heatIndex = 0;
-  CRGB color = ColorFromPalette(HeatColors_p, heatIndex);
-  if(sunposition < 4){
-    EVERY_N_MILLISECONDS(1000){
-      FastLED.clear(true);
-      //leds.DrawFilledCircle(3,++sunposition,3, color);
-      drawSun(3, ++sunposition, 3, color);
-      heatIndex+=5;
-      FastLED.show();
-    }
+  uint32_t elapsed = sequenceMillis();
+  uint32_t step = elapsed / SUNRISE_STEP_DELAY;
+  if(step < 10){
+    sunposition = -6 + step; //Start outside the view field
+    heatIndex = step * 5;
   } else {
-    //leds.DrawFilledCircle(3,sunposition,3, color);
-    EVERY_N_MILLISECONDS(30){
-      drawSun(3,sunposition,3, color);
-      FastLED.show();
-      if(heatIndex < 254) {
-        heatIndex++;
-      } else {
-        sunriseEndPositionReached = true;
-        //sunposition = -6; //Default for next time
-        //heatIndex = 0; //Default for next time
-      }
+    uint32_t glow = (elapsed - 10UL * SUNRISE_STEP_DELAY) / SUNRISE_GLOW_DELAY;
+    sunposition = 4;
+    heatIndex = min(50UL + glow, 254UL);
+    if(heatIndex == 254){
+      sunriseEndPositionReached = true;
     }
   }
+  CRGB color = ColorFromPalette(HeatColors_p, heatIndex);
+  FastLED.clear();
+  //leds.DrawFilledCircle(3,sunposition,3, color);
+  drawSun(3, sunposition, 3, color);
+}
+
+uint8_t applyFadeCurve(uint8_t progress, FadeCurve curve){
+  switch(curve){
+    case FADE_EASE_IN:
+      return scale8_video(progress, progress); //reaches 255 unlike scale8
+    case FADE_EASE_IN_OUT:
+      return ease8InOutQuad(progress);
+    default:
+      return progress;
+  }
+}
+
+/*
+Remembers when the wakeupSequence started, every animation and fade
+is calculated relative to this point in time.
+*/
+void controlSequenceTimeline(){
+  if(wakeUpProcessStarted && !sequenceStarted){
+    sequenceStartTime = millis();
+    sequenceStartFrame = frameCounter;
+    sequenceStarted = true;
+#if SYNC_MODE == SYNC_MASTER
+    syncSequenceStart = sequenceStartTime;
+#endif
+  }
+}
+
+/*
+A slave that is locked to a running master uses the timeline of the master,
+converted with the estimated clock offset. While frames are recorded, the
+timeline counts the frames shown since the start, so a recording is the
+same on every run.
+*/
+uint32_t sequenceMillis(){
+#if SYNC_MODE == SYNC_SLAVE
+  if(syncLocked && syncMasterRunning){
+    //the offset is only exact to half a round trip, the start may still lie ahead
+    int32_t elapsed = millis() + syncOffset - syncSequenceStart;
+    return elapsed > 0 ? elapsed : 0;
+  }
+#endif
+  if(!sequenceStarted){
+    return 0; //the timeline starts with the next loop
+  }
+#if FRAME_CAPTURE
+  //recordings advance by frames, however long a loop takes
+  return (frameCounter - sequenceStartFrame) * FPS_DELAY;
+#else
+  return millis() - sequenceStartTime;
+#endif
+}
+
+/*
+random16 is a linear congruential generator, so consecutive seeds would make
+every flame grow by the same amount from frame to frame. The frame number is
+mixed first (MurmurHash3 finalizer) to get unrelated flames in every frame.
+*/
+uint16_t mixFrame(uint32_t frame){
+  frame ^= frame >> 16;
+  frame *= 0x85EBCA6B;
+  frame ^= frame >> 13;
+  frame *= 0xC2B2AE35;
+  frame ^= frame >> 16;
+  return frame;
+}
+
+/*
+Fades the brightness and the volume from their start to their end values
+within FADE_DURATION after the alarm started. The brightness is only a
+variable in FastLED and is set every frame. The volume is only handed
+to updateDFPlayerVolume(), which decides when it is sent.
+*/
+void controlFade(){
+  if(!wakeUpProcessStarted){
+    return;
+  }
+  uint32_t elapsed = sequenceMillis();
+  uint8_t progress = elapsed >= FADE_DURATION ? 255 : (elapsed * 255UL) / FADE_DURATION;
+  FastLED.setBrightness(lerp8by8(BRIGHTNESS_START, BRIGHTNESS_END, applyFadeCurve(progress, BRIGHTNESS_CURVE)));
+  fadeVolume = lerp8by8(VOLUME_START, VOLUME, applyFadeCurve(progress, VOLUME_CURVE));
+}
 
+/*
+The SoftwareSerial to the DFPlayer is slow, so a volume command is only sent
+when the volume level actually changed and no other command was sent within
+DFPLAYER_COMMAND_GAP. Levels requested in between are merged into one command.
+*/
+void updateDFPlayerVolume(){
+  if(fadeVolume == sentVolume || millis() - lastDFPlayerCommand < DFPLAYER_COMMAND_GAP){
+    return;
+  }
+  myDFPlayer.volume(fadeVolume);
+  sentVolume = fadeVolume;
+  lastDFPlayerCommand = millis();
 }
 
 /*
@@ -538,17 +964,151 @@ Phase 1: Rising sun + first song
 Phase 2: Countdown + second song
 Phase 3: FireAnimation + remaining songs
 */
+WakeupPhase currentWakeupPhase(){
+  if(!wakeUpProcessStarted){
+    return PHASE_IDLE;
+  } else if(!sunriseEndPositionReached || !firstSongFinished){
+    return PHASE_SUNRISE;
+  } else if(!countdownFinished || !countdownAnimationFinished){
+    return PHASE_COUNTDOWN;
+  }
+  return PHASE_FIRE;
+}
+
+/*
+The effect draws into its own canvas effectFrame, which is only copied to
+leds while it draws. Effects that keep their frame, like the countdown,
+therefore stay untouched by the crossfade. When the phase changes, the
+frame on the matrix is kept in fadeFrame and blended out in fixed point.
+*/
+void renderWakeupEffect(WakeupPhase phase){
+  uint32_t start = micros();
+  CRGB *screen = leds[0];
+  if(phase != renderedPhase){
+    memcpy(fadeFrame, screen, sizeof(fadeFrame));
+    fill_solid(effectFrame, NUM_LEDS, CRGB::Black);
+    renderedPhase = phase;
+    crossfade = 0;
+  }
+
+  memcpy(screen, effectFrame, sizeof(effectFrame));
+  WakeupEffects::render(phase);
+  memcpy(effectFrame, screen, sizeof(effectFrame));
+
+  if(crossfade < 255){
+    crossfade = qadd8(crossfade, CROSSFADE_STEP);
+    nblend(screen, fadeFrame, NUM_LEDS, 255 - crossfade);
+  }
+  effectRenderMicros = micros() - start;
+}
+
+//------------------------------------------------------------------------------
+// Frame Capture
+//------------------------------------------------------------------------------
+/*
+Frame log, all numbers little endian:
+
+Header, 8 bytes:
+  "LWFL"  magic
+  uint8   version, 1
+  uint8   MATRIX_WIDTH
+  uint8   MATRIX_HEIGHT
+  uint8   FPS
+Record per changed frame, 7 + 4 * count bytes:
+  uint32  time in Miliseconds on the timeline of the wakeupSequence, which
+          counts frames while recording, frameCounter * FPS_DELAY when idle
+  uint8   brightness
+  uint8   WakeupPhase
+  uint8   count of changed pixels
+  count * (uint8 index in leds, uint8 red, uint8 green, uint8 blue)
+
+Every record only holds the pixels that differ from the frame before, the first
+one differs from a black frame. Frames without a change are not recorded, a
+replay keeps showing the last frame until the next record. The size of a record
+follows from its count, so a mapped log can be walked without decoding pixels.
+*/
+void startFrameCapture(){
+#if FRAME_CAPTURE
+  const uint8_t header[] = {'L', 'W', 'F', 'L', 1, MATRIX_WIDTH, MATRIX_HEIGHT, FPS};
+  memcpy(captureLog, header, sizeof(header));
+  captureLength = sizeof(header);
+  fill_solid(capturedFrame, NUM_LEDS, CRGB::Black);
+  capturedBrightness = 0;
+#endif
+}
+
+void captureFrame(){
+#if FRAME_CAPTURE
+  static bool wasRunning = false;
+  if(wakeUpProcessStarted && !wasRunning){
+    startFrameCapture(); //one log per alarm
+  }
+  wasRunning = wakeUpProcessStarted;
+
+  WakeupPhase phase = currentWakeupPhase();
+  if(phase != FRAME_CAPTURE_PHASE){
+    return;
+  }
+  CRGB *screen = leds[0];
+  uint8_t brightness = FastLED.getBrightness();
+  uint8_t changed = 0;
+  for(uint8_t i = 0; i < NUM_LEDS; i++){
+    if(screen[i] != capturedFrame[i]){
+      changed++;
+    }
+  }
+  if(changed == 0 && brightness == capturedBrightness){
+    return;
+  }
+  if(captureLength + 7 + 4 * changed > FRAME_CAPTURE_SIZE){
+    return; //log is full
+  }
+
+  uint32_t timestamp = wakeUpProcessStarted ? sequenceMillis() : frameCounter * FPS_DELAY;
+  uint8_t *record = captureLog + captureLength;
+  *record++ = timestamp;
+  *record++ = timestamp >> 8;
+  *record++ = timestamp >> 16;
+  *record++ = timestamp >> 24;
+  *record++ = brightness;
+  *record++ = phase;
+  *record++ = changed;
+  for(uint8_t i = 0; i < NUM_LEDS; i++){
+    if(screen[i] != capturedFrame[i]){
+      *record++ = i;
+      *record++ = screen[i].r;
+      *record++ = screen[i].g;
+      *record++ = screen[i].b;
+      capturedFrame[i] = screen[i];
+    }
+  }
+  captureLength = record - captureLog;
+  capturedBrightness = brightness;
+#endif
+}
+
+/*
+Every frame of the loop goes through here, frameCounter therefore counts
+exactly the frames that are recorded and shown.
+*/
+void showFrame(){
+  captureFrame();
+  FastLED.show();
+  frameCounter++;
+}
+
 void controlWakeupSequence(){
-  if(wakeUpProcessStarted && (!sunriseEndPositionReached || !firstSongFinished)){
+  WakeupPhase phase = currentWakeupPhase();
+  if(phase == PHASE_SUNRISE){
     playFirstSong();
-    showSunrise();
-  } else if(wakeUpProcessStarted && sunriseEndPositionReached && firstSongFinished && (!countdownFinished || !countdownAnimationFinished)){
-    showCountdown();
+  } else if(phase == PHASE_COUNTDOWN){
     playCountDown();
-  } else if(wakeUpProcessStarted && sunriseEndPositionReached && countdownFinished ){
-    showFireAnimation();
+  } else if(phase == PHASE_FIRE){
     playNextSongWhenFinished();
   }
+  if(phase != PHASE_IDLE){
+    renderWakeupEffect(phase);
+  }
   if(wakeUpProcessStopped){
     stopWakeUpProcess();
     currentNumber = 10;
@@ -639,6 +1199,159 @@ void showTime(){
   }
 }
 
+/*
+The DFPlayer reports a changed SD-Card on its own, so listening costs
+no round-trip. The index is only read again when no alarm is running.
+*/
+void checkDFPlayerCard(){
+  if(myDFPlayer.available()){
+    uint8_t type = myDFPlayer.readType();
+    if(type == DFPlayerCardInserted || type == DFPlayerCardOnline){
+      trackIndexDirty = true;
+    } else if(type == DFPlayerCardRemoved){
+      trackCount = 0;
+      folderCount = 0;
+      playlistLength = 0;
+    }
+  }
+  if(trackIndexDirty && !wakeUpProcessStarted){
+    readTrackIndex();
+  }
+}
+
+//------------------------------------------------------------------------------
+// Sync between several units
+//------------------------------------------------------------------------------
+void setupSync(){
+#if SYNC_MODE != SYNC_OFF
+  Serial.print(F("Joining sync group..."));
+  syncUdp.beginMulticast(WiFi.localIP(), syncGroup, SYNC_PORT);
+  Serial.print(F("done\n"));
+#endif
+}
+
+/*
+The master sends a beacon with the state of its wakeupSequence to the group.
+Every slave asks the master for clock samples and starts and stops its
+wakeupSequence together with the master. Only packets that are already
+received are read, so this never waits for the network.
+*/
+void controlSync(){
+#if SYNC_MODE != SYNC_OFF
+  static uint32_t lastSyncSend = 0;
+  SyncPacket packet;
+
+  while(syncUdp.parsePacket() == sizeof(SyncPacket)){
+    syncUdp.read((uint8_t *)&packet, sizeof(packet));
+    if(packet.magic == SYNC_MAGIC){
+      handleSyncPacket(packet);
+    }
+  }
+
+#if SYNC_MODE == SYNC_MASTER
+  static bool lastRunning = false;
+  //a changed state is sent at once, otherwise every SYNC_BEACON_INTERVAL
+  if(millis() - lastSyncSend >= SYNC_BEACON_INTERVAL || wakeUpProcessStarted != lastRunning){
+    memset(&packet, 0, sizeof(packet));
+    packet.magic = SYNC_MAGIC;
+    packet.type = SYNC_BEACON;
+    packet.running = wakeUpProcessStarted;
+    packet.sequenceStart = syncSequenceStart;
+    packet.t3 = millis();
+    syncUdp.beginPacketMulticast(syncGroup, SYNC_PORT, WiFi.localIP());
+    syncUdp.write((const uint8_t *)&packet, sizeof(packet));
+    syncUdp.endPacket();
+    lastSyncSend = millis();
+    lastRunning = wakeUpProcessStarted;
+  }
+#else
+  if(syncMasterKnown && millis() - lastSyncSend >= SYNC_REQUEST_INTERVAL){
+    memset(&packet, 0, sizeof(packet));
+    packet.magic = SYNC_MAGIC;
+    packet.type = SYNC_REQUEST;
+    packet.t1 = millis();
+    sendSyncPacket(packet, syncMasterIP, SYNC_PORT);
+    lastSyncSend = millis();
+  }
+#endif
+#endif
+}
+
+#if SYNC_MODE != SYNC_OFF
+void sendSyncPacket(SyncPacket &packet, IPAddress ip, uint16_t port){
+  syncUdp.beginPacket(ip, port);
+  syncUdp.write((const uint8_t *)&packet, sizeof(packet));
+  syncUdp.endPacket();
+}
+
+void handleSyncPacket(SyncPacket &packet){
+#if SYNC_MODE == SYNC_MASTER
+  if(packet.type == SYNC_REQUEST){
+    packet.t2 = millis();
+    packet.type = SYNC_RESPONSE;
+    packet.t3 = millis();
+    sendSyncPacket(packet, syncUdp.remoteIP(), syncUdp.remotePort());
+  }
+#else
+  if(packet.type == SYNC_BEACON){
+    //another master or a restarted one has another clock, old samples would be wrong
+    bool otherMaster = syncMasterKnown && !(syncUdp.remoteIP() == syncMasterIP);
+    int32_t clockJump = packet.t3 - (millis() + syncOffset);
+    if(otherMaster || (syncLocked && abs(clockJump) > SYNC_BEACON_INTERVAL)){
+      Serial.println(F("!! NEW SYNC MASTER !!"));
+      resetSyncSamples();
+    }
+    syncMasterIP = syncUdp.remoteIP();
+    syncMasterKnown = true;
+    syncSequenceStart = packet.sequenceStart;
+    //only changes of the master are followed, the own buttons keep working
+    if(packet.running && !syncMasterRunning){
+      Serial.println(F("!! ALARM STARTED BY MASTER !!"));
+      wakeUpProcessStarted = true;
+      wakeUpProcessStopped = false;
+    } else if(!packet.running && syncMasterRunning){
+      wakeUpProcessStarted = false;
+      wakeUpProcessStopped = true;
+    }
+    syncMasterRunning = packet.running;
+  } else if(packet.type == SYNC_RESPONSE){
+    addSyncSample(packet.t1, packet.t2, packet.t3, millis());
+  }
+#endif
+}
+
+/*
+Same estimation as NTP: the offset is exact if the way to the master takes
+as long as the way back. Samples with a small round trip are delayed the
+least by the network, so the offset of the fastest sample is used.
+*/
+void addSyncSample(uint32_t t1, uint32_t t2, uint32_t t3, uint32_t t4){
+  SyncSample &sample = syncSamples[syncSampleIndex];
+  sample.offset = ((int32_t)(t2 - t1) + (int32_t)(t3 - t4)) / 2;
+  sample.roundTrip = (t4 - t1) - (t3 - t2);
+  syncSampleIndex = (syncSampleIndex + 1) % SYNC_SAMPLES;
+  if(syncSampleCount < SYNC_SAMPLES){
+    syncSampleCount++;
+  }
+
+  uint8_t best = 0;
+  for(uint8_t i = 1; i < syncSampleCount; i++){
+    if(syncSamples[i].roundTrip < syncSamples[best].roundTrip){
+      best = i;
+    }
+  }
+  syncOffset = syncSamples[best].offset;
+  syncRoundTrip = syncSamples[best].roundTrip;
+  syncLocked = true;
+}
+
+void resetSyncSamples(){
+  syncSampleCount = 0;
+  syncSampleIndex = 0;
+  syncLocked = false;
+}
+#endif
+
 void checkAlarmTime(){
   if(currentHour == alarmHour && currentMinute == alarmMinute && wakeUpProcessStarted == false){
     Serial.println(F("!! ALARM STARTED !!"));
@@ -663,10 +1376,219 @@ void printDebug(){
     Serial.print(countdownFinished);
     Serial.print("\ncountdownAnimationFinished: ");
     Serial.print(countdownAnimationFinished);
+    Serial.print("\neffectRenderMicros: ");
+    Serial.print(effectRenderMicros);
     Serial.println();
   }
 }
 
+//------------------------------------------------------------------------------
+// JSON API
+//------------------------------------------------------------------------------
+const char* wakeupPhaseName(){
+  switch(currentWakeupPhase()){
+    case PHASE_SUNRISE:
+      return "sunrise";
+    case PHASE_COUNTDOWN:
+      return "countdown";
+    case PHASE_FIRE:
+      return "fire";
+    default:
+      return "idle";
+  }
+}
+
+/*
+The state is compared field by field with the state of the current
+version. The version only increases when a field changed, so polling
+clients get a 304 Not Modified as long as nothing happened.
+*/
+uint32_t updateStateVersion(){
+  ApiState state;
+  state.alarmHour = alarmHour;
+  state.alarmMinute = alarmMinute;
+  state.alarmFolder = alarmFolder;
+  state.alarmShuffle = alarmShuffle;
+  state.running = wakeUpProcessStarted;
+  state.music = musicStarted;
+  state.phase = currentWakeupPhase();
+  state.trackCount = trackCount;
+  state.folderCount = folderCount;
+  if(memcmp(&state, &publishedState, sizeof(state)) != 0 || stateVersion == 0){
+    publishedState = state;
+    stateVersion++;
+  }
+  return stateVersion;
+}
+
+/*
+Finds "key": in a flat JSON object and reads the number or boolean behind it.
+Returns 1 if the value was read, 0 if the key is missing and -1 if the value
+is not a number. Enough for the small objects of the API.
+*/
+int8_t readJsonValue(const char *json, const char *key, int &value){
+  char pattern[16];
+  snprintf(pattern, sizeof(pattern), "\"%s\"", key);
+  const char *found = strstr(json, pattern);
+  if(found == NULL){
+    return 0;
+  }
+  found = strchr(found + strlen(pattern), ':');
+  if(found == NULL){
+    return -1;
+  }
+  found++;
+  while(*found == ' '){
+    found++;
+  }
+  if(strncmp(found, "true", 4) == 0){
+    value = 1;
+    return 1;
+  }
+  if(strncmp(found, "false", 5) == 0){
+    value = 0;
+    return 1;
+  }
+  char *end;
+  long number = strtol(found, &end, 10);
+  if(end == found){
+    return -1;
+  }
+  value = number;
+  return 1;
+}
+
+/*
+Header and body are written with one call each from the stack,
+no String is built for the response.
+*/
+void sendApiResponse(WiFiClient &client, const char *status, const char *body, int length){
+  char header[160];
+  int headerLength = snprintf(header, sizeof(header),
+    "HTTP/1.1 %s\r\n"
+    "Content-Type: application/json\r\n"
+    "ETag: \"%lu\"\r\n"
+    "Content-Length: %d\r\n"
+    "Connection: close\r\n\r\n",
+    status, (unsigned long)stateVersion, length);
+  client.write((const uint8_t *)header, headerLength);
+  if(length > 0){
+    client.write((const uint8_t *)body, length);
+  }
+}
+
+void sendApiState(WiFiClient &client, bool notModified){
+  if(notModified){
+    sendApiResponse(client, "304 Not Modified", NULL, 0);
+    return;
+  }
+  char body[API_RESPONSE_SIZE];
+  int length = snprintf(body, sizeof(body),
+    "{\"version\":%lu,"
+    "\"alarm\":{\"hour\":%u,\"minute\":%u,\"folder\":%u,\"shuffle\":%s},"
+    "\"running\":%s,\"phase\":\"%s\",\"music\":%s,"
+    "\"tracks\":%u,\"folders\":%u}",
+    (unsigned long)stateVersion,
+    alarmHour, alarmMinute, alarmFolder, alarmShuffle ? "true" : "false",
+    wakeUpProcessStarted ? "true" : "false", wakeupPhaseName(), musicStarted ? "true" : "false",
+    trackCount, folderCount);
+  sendApiResponse(client, "200 OK", body, min(length, (int)sizeof(body) - 1));
+}
+
+/*
+GET  /api/state        state of the Lichtwecker, supports If-None-Match
+PUT  /api/alarms       {"hour":6,"minute":30,"folder":2,"shuffle":true}
+                       every field is optional, all are checked before
+                       any is applied
+POST /api/alarm/start  starts the wakeupSequence
+POST /api/alarm/stop   stops the wakeupSequence
+GET  /api/frames       frame log, only with FRAME_CAPTURE
+*/
+void controlApi(WiFiClient &client, String &request){
+  char body[API_BODY_SIZE + 1];
+  int contentLength = 0;
+  String ifNoneMatch = "";
+
+  client.readStringUntil('\n'); //rest of the request line
+  while(client.connected()){
+    String line = client.readStringUntil('\n');
+    line.trim();
+    if(line.length() == 0){
+      break; //end of the header
+    }
+    line.toLowerCase();
+    if(line.startsWith("content-length:")){
+      contentLength = line.substring(15).toInt();
+    } else if(line.startsWith("if-none-match:")){
+      ifNoneMatch = line.substring(14);
+      ifNoneMatch.trim();
+    }
+  }
+  if(contentLength < 0){
+    const char error[] = "{\"error\":\"invalid content length\"}";
+    sendApiResponse(client, "400 Bad Request", error, sizeof(error) - 1);
+    return;
+  }
+  if(contentLength > API_BODY_SIZE){
+    const char error[] = "{\"error\":\"body too large\"}";
+    sendApiResponse(client, "413 Payload Too Large", error, sizeof(error) - 1);
+    return;
+  }
+  body[client.readBytes(body, contentLength)] = '\0';
+
+  if(request.startsWith("GET /api/state ")){
+    char etag[16];
+    snprintf(etag, sizeof(etag), "\"%lu\"", (unsigned long)updateStateVersion());
+    sendApiState(client, ifNoneMatch.equals(etag));
+#if FRAME_CAPTURE
+  } else if(request.startsWith("GET /api/frames ")){
+    char header[128];
+    int headerLength = snprintf(header, sizeof(header),
+      "HTTP/1.1 200 OK\r\n"
+      "Content-Type: application/octet-stream\r\n"
+      "Content-Length: %u\r\n"
+      "Connection: close\r\n\r\n",
+      captureLength);
+    client.write((const uint8_t *)header, headerLength);
+    client.write(captureLog, captureLength);
+#endif
+  } else if(request.startsWith("PUT /api/alarms ")){
+    int hour = alarmHour;
+    int minute = alarmMinute;
+    int folder = alarmFolder;
+    int shuffle = alarmShuffle;
+    int8_t foundHour = readJsonValue(body, "hour", hour);
+    int8_t foundMinute = readJsonValue(body, "minute", minute);
+    int8_t foundFolder = readJsonValue(body, "folder", folder);
+    int8_t foundShuffle = readJsonValue(body, "shuffle", shuffle);
+    bool anyFound = foundHour > 0 || foundMinute > 0 || foundFolder > 0 || foundShuffle > 0;
+    bool anyInvalid = foundHour < 0 || foundMinute < 0 || foundFolder < 0 || foundShuffle < 0;
+    if(!anyFound || anyInvalid || hour < 0 || hour > 23 || minute < 0 || minute > 59
+        || folder < 0 || folder > MAX_FOLDERS || shuffle < 0 || shuffle > 1){
+      const char error[] = "{\"error\":\"invalid alarm\"}";
+      sendApiResponse(client, "400 Bad Request", error, sizeof(error) - 1);
+      return;
+    }
+    alarmHour = hour;
+    alarmMinute = minute;
+    alarmFolder = folder;
+    alarmShuffle = shuffle;
+    updateStateVersion();
+    sendApiState(client, false);
+  } else if(request.startsWith("POST /api/alarm/start ")){
+    wakeUpProcessStarted = true;
+    wakeUpProcessStopped = false;
+    sendApiResponse(client, "204 No Content", NULL, 0);
+  } else if(request.startsWith("POST /api/alarm/stop ")){
+    wakeUpProcessStarted = false;
+    wakeUpProcessStopped = true;
+    sendApiResponse(client, "204 No Content", NULL, 0);
+  } else {
+    const char error[] = "{\"error\":\"not found\"}";
+    sendApiResponse(client, "404 Not Found", error, sizeof(error) - 1);
+  }
+}
+
 /*
 waits for a client and builds a webseite when someone is connected
 */
@@ -678,6 +1600,12 @@ void controlWebsite(){
     Serial.println("!! Request: ");
     Serial.println(request);
 
+    //automation gets JSON instead of the whole website
+    if(request.indexOf(" /api/") != -1){
+      controlApi(client, request);
+      return;
+    }
+
     //evaluating the HTTP Request and setting the variables respectively
     if(request.indexOf("/ALARM_ON") != -1){
       wakeUpProcessStarted = true;
@@ -714,6 +1642,16 @@ void controlWebsite(){
       Serial.print("ende\n");
     }
 
+    if(request.indexOf("FOLDER") != -1){
+      int index = request.indexOf("FOLDER");
+      uint8_t newFolder = request.substring(index + 7, index + 9).toInt();
+      if(newFolder <= MAX_FOLDERS){
+        alarmFolder = newFolder;
+      }
+      //an unchecked checkbox is not sent with the form
+      alarmShuffle = request.indexOf("SHUFFLE") != -1;
+    }
+
     client.println("HTTP/1.1 200 OK");
     client.println("Content-Type: text/html");
     client.println();
@@ -743,6 +1681,15 @@ void controlWebsite(){
     client.print(alarmMinute);
     client.print("\">");
 
+    client.println("<br/>");
+    client.print("playlist folder (0 = all): <input type=\"text\" name=\"FOLDER\" maxlength=\"2\" size=\"2\" value=\"");
+    client.print(alarmFolder);
+    client.print("\">");
+
+    client.print("shuffle: <input type=\"checkbox\" name=\"SHUFFLE\"");
+    if(alarmShuffle) client.print(" checked");
+    client.println(">");
+
     client.println("<input type=\"submit\" value=\"set\">");
     client.println("</form>");
     client.println("<br/><br/>");
@@ -765,6 +1712,16 @@ void controlWebsite(){
     client.print("<br/>");
     client.print("countdownStarted: ");
     client.print(countdownStarted);
+    client.print("<br/>");
+    client.print("songs on SD-Card: ");
+    client.print(trackCount);
+    client.print(" in ");
+    client.print(folderCount);
+    client.print(" folders");
+    client.print("<br/>");
+    client.print("effect render time: ");
+    client.print(effectRenderMicros);
+    client.print(" us");
 
     client.println("</body>");
     client.println("</html>");
@@ -780,9 +1737,14 @@ void loop(){
   updateTime();
   readInputPins();
   controlWebsite();
+  controlSequenceTimeline(); //before controlSync(), the beacon carries the start
+  controlSync();
+  checkDFPlayerCard();
+  controlFade();
   controlWakeupSequence();
+  updateDFPlayerVolume();
   controlShowTimeSequence();
   checkAlarmTime();
-  FastLED.show();
+  showFrame();
   FastLED.delay(FPS_DELAY); //Refresh Rate
 }
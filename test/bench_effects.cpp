@@ -0,0 +1,63 @@
+// Time per frame of the effect registry against one direct call per phase,
+// and of the whole renderWakeupEffect() with crossfade. Only prints, the
+// times depend on the host and are no test.
+#include <chrono>
+#include "../lichtwecker.cpp"
+
+#define BENCH_FRAMES 2000
+#define BENCH_REPS   100
+
+static void renderDirect(uint8_t phase){
+  switch(phase){
+    case PHASE_IDLE:      FastLED.clear(); break;
+    case PHASE_SUNRISE:   showSunrise(); break;
+    case PHASE_COUNTDOWN: showCountdown(); break;
+    case PHASE_FIRE:      showFireAnimation(); break;
+  }
+}
+
+static void renderRegistry(uint8_t phase){
+  WakeupEffects::render(phase);
+}
+
+static void renderPipeline(uint8_t phase){
+  crossfade = 0; //every frame with the crossfade, the worst case
+  renderWakeupEffect((WakeupPhase)phase);
+}
+
+//fastest run of BENCH_FRAMES frames in nanoseconds per frame
+static double measure(void (*render)(uint8_t), uint8_t phase){
+  volatile uint8_t hidden = phase; //no constant folding of the phase
+  double best = 1e18;
+  for(int rep = 0; rep < BENCH_REPS; rep++){
+    auto start = std::chrono::steady_clock::now();
+    for(int frame = 0; frame < BENCH_FRAMES; frame++){
+      render(hidden);
+    }
+    std::chrono::duration<double, std::nano> took = std::chrono::steady_clock::now() - start;
+    best = std::min(best, took.count() / BENCH_FRAMES);
+  }
+  return best;
+}
+
+int main(){
+  setup();
+  wakeUpProcessStarted = true;
+  controlSequenceTimeline();
+  host::now += 5 * SUNRISE_STEP_DELAY + 50; //the sun is on its way up
+
+  const WakeupPhase phases[] = {PHASE_SUNRISE, PHASE_FIRE};
+  for(WakeupPhase phase : phases){
+    //alternating, so neither path profits from a warm cache alone
+    double direct = measure(renderDirect, phase);
+    double registry = measure(renderRegistry, phase);
+    direct = std::min(direct, measure(renderDirect, phase));
+    registry = std::min(registry, measure(renderRegistry, phase));
+    renderedPhase = phase;
+    double pipeline = measure(renderPipeline, phase);
+
+    printf("bench_effects: %-8s direct %6.0f ns, registry %6.0f ns, renderWakeupEffect %6.0f ns per frame\n",
+      phase == PHASE_SUNRISE ? "sunrise" : "fire", direct, registry, pipeline);
+  }
+  return 0;
+}
@@ -0,0 +1,194 @@
+// Tool for the frame logs of lichtwecker.cpp, downloaded with GET /api/frames
+// or written by the golden tests.
+//
+//   framelog info LOG                       header and size of the log
+//   framelog show LOG [--fast]              replays the log in a truecolor terminal
+//   framelog ppm LOG OUT.ppm [--scale N]    every record side by side in one image
+//   framelog diff A B [--max-error N]       exits with 1 when a channel differs by more than N
+//
+#include <time.h>
+#include "framelog.h"
+
+static const char *phaseName(uint8_t phase){
+  static const char *names[] = {"idle", "sunrise", "countdown", "fire"};
+  return phase < 4 ? names[phase] : "unknown";
+}
+
+static int usage(){
+  fprintf(stderr,
+    "usage: framelog info LOG\n"
+    "       framelog show LOG [--fast]\n"
+    "       framelog ppm LOG OUT.ppm [--scale N]\n"
+    "       framelog diff A B [--max-error N]\n");
+  return 2;
+}
+
+static bool openLog(FrameLogReader &log, const char *path){
+  if(log.map(path)) return true;
+  fprintf(stderr, "%s: %s\n", path, log.error());
+  return false;
+}
+
+//value of an option like --scale 4, fallback when it is missing
+static int option(int argc, char **argv, const char *name, int fallback){
+  for(int i = 0; i + 1 < argc; i++){
+    if(strcmp(argv[i], name) == 0) return atoi(argv[i + 1]);
+  }
+  return fallback;
+}
+
+static bool flag(int argc, char **argv, const char *name){
+  for(int i = 0; i < argc; i++){
+    if(strcmp(argv[i], name) == 0) return true;
+  }
+  return false;
+}
+
+static int info(FrameLogReader &log){
+  size_t pixels = 0;
+  uint32_t first = 0;
+  bool phases[256] = {false};
+  while(log.next()){
+    if(log.recordsRead() == 1) first = log.time;
+    pixels += log.changed;
+    phases[log.phase] = true;
+  }
+  printf("matrix   %ux%u at %u FPS\n", log.width, log.height, log.fps);
+  printf("records  %zu, %zu changed pixels, %zu bytes\n", log.recordsRead(), pixels, log.bytes());
+  if(log.recordsRead() > 0){
+    printf("time     %u ... %u ms\n", first, log.time);
+  }
+  printf("phases  ");
+  for(int phase = 0; phase < 256; phase++){
+    if(phases[phase]) printf(" %s", phaseName(phase));
+  }
+  printf("\n");
+  if(log.error()){
+    fprintf(stderr, "broken log after %zu records: %s\n", log.recordsRead(), log.error());
+    return 1;
+  }
+  return 0;
+}
+
+//two characters per pixel, the top row of the matrix first
+static void drawFrame(const FrameLogReader &log){
+  for(int y = log.height - 1; y >= 0; y--){
+    for(int x = 0; x < log.width; x++){
+      const FramePixel &pixel = log.at(x, y);
+      printf("\x1b[48;2;%u;%u;%um  ", pixel.r, pixel.g, pixel.b);
+    }
+    printf("\x1b[0m\n");
+  }
+  printf("%8u ms  %-9s  brightness %3u  %3u changed\n", log.time, phaseName(log.phase), log.brightness, log.changed);
+}
+
+static int show(FrameLogReader &log, bool fast){
+  uint32_t previous = 0;
+  bool first = true;
+  while(log.next()){
+    if(!first){
+      if(!fast && log.time > previous){
+        uint32_t wait = log.time - previous;
+        struct timespec pause = {(time_t)(wait / 1000), (long)(wait % 1000) * 1000000L};
+        nanosleep(&pause, NULL);
+      }
+      printf("\x1b[%uA", log.height + 1); //draw over the last frame
+    }
+    drawFrame(log);
+    fflush(stdout);
+    previous = log.time;
+    first = false;
+  }
+  if(log.error()){
+    fprintf(stderr, "broken log after %zu records: %s\n", log.recordsRead(), log.error());
+    return 1;
+  }
+  return 0;
+}
+
+/*
+Binary PPM, so no image library is needed. The records are placed in rows
+of 16 frames, separated by a grey gap of one pixel.
+*/
+static int ppm(FrameLogReader &log, const char *path, int scale){
+  const int columns = 16;
+  size_t records = 0;
+  while(log.next()) records++;
+  if(log.error()){
+    fprintf(stderr, "broken log after %zu records: %s\n", log.recordsRead(), log.error());
+    return 1;
+  }
+  if(records == 0){
+    fprintf(stderr, "no records\n");
+    return 1;
+  }
+  int tileWidth = log.width * scale + 1;
+  int tileHeight = log.height * scale + 1;
+  int imageWidth = tileWidth * (records < columns ? records : columns) + 1;
+  int imageHeight = tileHeight * ((records + columns - 1) / columns) + 1;
+  std::vector<uint8_t> image(imageWidth * imageHeight * 3, 64);
+
+  log.rewind();
+  for(size_t record = 0; log.next(); record++){
+    int left = 1 + tileWidth * (record % columns);
+    int top = 1 + tileHeight * (record / columns);
+    for(int y = 0; y < log.height * scale; y++){
+      for(int x = 0; x < log.width * scale; x++){
+        const FramePixel &pixel = log.at(x / scale, log.height - 1 - y / scale);
+        uint8_t *target = &image[((top + y) * imageWidth + left + x) * 3];
+        target[0] = pixel.r;
+        target[1] = pixel.g;
+        target[2] = pixel.b;
+      }
+    }
+  }
+
+  FILE *file = fopen(path, "wb");
+  if(!file){
+    fprintf(stderr, "%s: cannot write\n", path);
+    return 1;
+  }
+  fprintf(file, "P6\n%d %d\n255\n", imageWidth, imageHeight);
+  fwrite(image.data(), 1, image.size(), file);
+  fclose(file);
+  printf("%zu frames written to %s\n", records, path);
+  return 0;
+}
+
+static int diff(FrameLogReader &a, FrameLogReader &b, int maxError){
+  FrameLogDiff result = compareFrameLogs(a, b);
+  if(result.error){
+    fprintf(stderr, "cannot compare: %s\n", result.error);
+    return 2;
+  }
+  printf("%zu frames compared, %zu differ, largest error %u\n", result.frames, result.differentFrames, result.maxError);
+  if(result.differentFrames > 0){
+    if(result.firstPixel < 0){
+      printf("first difference at %u ms in the brightness\n", result.firstTime);
+    } else {
+      printf("first difference at %u ms in pixel %d (x %d, y %d)\n", result.firstTime, result.firstPixel,
+        result.firstPixel / a.height, result.firstPixel % a.height);
+    }
+  }
+  return result.maxError > maxError ? 1 : 0;
+}
+
+int main(int argc, char **argv){
+  if(argc < 3) return usage();
+  const char *command = argv[1];
+  FrameLogReader log;
+  if(strcmp(command, "info") == 0){
+    return openLog(log, argv[2]) ? info(log) : 2;
+  } else if(strcmp(command, "show") == 0){
+    return openLog(log, argv[2]) ? show(log, flag(argc, argv, "--fast")) : 2;
+  } else if(strcmp(command, "ppm") == 0 && argc >= 4){
+    int scale = option(argc, argv, "--scale", 4);
+    if(scale < 1) return usage();
+    return openLog(log, argv[2]) ? ppm(log, argv[3], scale) : 2;
+  } else if(strcmp(command, "diff") == 0 && argc >= 4){
+    FrameLogReader other;
+    if(!openLog(log, argv[2]) || !openLog(other, argv[3])) return 2;
+    return diff(log, other, option(argc, argv, "--max-error", 0));
+  }
+  return usage();
+}
@@ -0,0 +1,208 @@
+// Reader for the frame logs of lichtwecker.cpp, see startFrameCapture() for
+// the format. A log is mapped or attached as it is and walked record by
+// record, the reader keeps the whole frame up to date. Does not depend on
+// the stubs, so the tool and the tests share it.
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#define FRAMELOG_HEADER_SIZE 8
+#define FRAMELOG_RECORD_SIZE 7
+
+struct FramePixel {
+  uint8_t r, g, b;
+  bool operator==(const FramePixel &other) const { return r == other.r && g == other.g && b == other.b; }
+  bool operator!=(const FramePixel &other) const { return !(*this == other); }
+};
+
+class FrameLogReader {
+  public:
+    uint8_t width = 0;
+    uint8_t height = 0;
+    uint8_t fps = 0;
+    //the frame after the last call of next()
+    uint32_t time = 0;
+    uint8_t brightness = 0;
+    uint8_t phase = 0;
+    uint8_t changed = 0;
+    std::vector<FramePixel> pixels;
+
+    FrameLogReader(){}
+    FrameLogReader(const FrameLogReader &) = delete;
+    FrameLogReader &operator=(const FrameLogReader &) = delete;
+    ~FrameLogReader(){ unmap(); }
+
+    //maps a log file, false with error() set when it is no frame log
+    bool map(const char *path){
+      unmap();
+      int file = open(path, O_RDONLY);
+      if(file < 0) return fail("cannot open file");
+      struct stat info;
+      if(fstat(file, &info) != 0 || info.st_size == 0){
+        close(file);
+        return fail("empty file");
+      }
+      void *mapped = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+      close(file);
+      if(mapped == MAP_FAILED) return fail("cannot map file");
+      mappedSize = info.st_size;
+      return attach((const uint8_t *)mapped, mappedSize);
+    }
+
+    //reads a log in memory, like captureLog of the sketch
+    bool attach(const uint8_t *log, size_t length){
+      message = NULL;
+      data = log;
+      size = length;
+      if(size < FRAMELOG_HEADER_SIZE || memcmp(data, "LWFL", 4) != 0) return fail("no frame log");
+      if(data[4] != 1) return fail("unknown version");
+      width = data[5];
+      height = data[6];
+      fps = data[7];
+      if(width == 0 || height == 0 || width * height > 256) return fail("invalid matrix size");
+      rewind();
+      return true;
+    }
+
+    //back to the black frame before the first record
+    void rewind(){
+      position = FRAMELOG_HEADER_SIZE;
+      records = 0;
+      time = 0;
+      brightness = 0;
+      phase = 0;
+      changed = 0;
+      pixels.assign(width * height, FramePixel{0, 0, 0});
+    }
+
+    //applies the next record, false at the end of the log or on a broken record
+    bool next(){
+      if(position == size) return false;
+      if(size - position < FRAMELOG_RECORD_SIZE) return fail("truncated record");
+      const uint8_t *record = data + position;
+      uint8_t count = record[6];
+      size_t length = FRAMELOG_RECORD_SIZE + 4 * count;
+      if(size - position < length) return fail("truncated record");
+      for(uint8_t i = 0; i < count; i++){
+        if(record[FRAMELOG_RECORD_SIZE + 4 * i] >= pixels.size()) return fail("pixel outside the matrix");
+      }
+
+      time = record[0] | record[1] << 8 | record[2] << 16 | (uint32_t)record[3] << 24;
+      brightness = record[4];
+      phase = record[5];
+      changed = count;
+      for(const uint8_t *pixel = record + FRAMELOG_RECORD_SIZE; pixel < record + length; pixel += 4){
+        pixels[pixel[0]] = FramePixel{pixel[1], pixel[2], pixel[3]};
+      }
+      position += length;
+      records++;
+      return true;
+    }
+
+    //the frame is stored column by column with y = 0 at the bottom, like VERTICAL_MATRIX
+    const FramePixel &at(uint8_t x, uint8_t y) const { return pixels[x * height + y]; }
+
+    size_t recordsRead() const { return records; }
+    size_t bytes() const { return size; }
+    const char *error() const { return message; }
+
+  private:
+    const uint8_t *data = NULL;
+    size_t size = 0;
+    size_t mappedSize = 0;
+    size_t position = 0;
+    size_t records = 0;
+    const char *message = NULL;
+
+    bool fail(const char *text){
+      message = text;
+      return false;
+    }
+
+    void unmap(){
+      if(mappedSize > 0) munmap((void *)data, mappedSize);
+      mappedSize = 0;
+      data = NULL;
+      size = 0;
+    }
+};
+
+struct FrameLogDiff {
+  size_t frames = 0;          //points of time compared
+  size_t differentFrames = 0; //frames with at least one differing pixel or brightness
+  uint8_t maxError = 0;       //largest difference of one color channel or the brightness
+  uint32_t firstTime = 0;     //time of the first differing frame
+  int firstPixel = -1;        //index of the first differing pixel, -1 = brightness
+  const char *error = NULL;   //set when a log is broken or the matrices differ
+};
+
+/*
+Compares two logs on their timeline. A log only has records for changed
+frames, so at every time of a record in either log both frames are compared
+as they are at that time. Both readers are rewound first.
+*/
+inline FrameLogDiff compareFrameLogs(FrameLogReader &a, FrameLogReader &b){
+  FrameLogDiff diff;
+  if(a.width != b.width || a.height != b.height){
+    diff.error = "matrix sizes differ";
+    return diff;
+  }
+  //frames[] holds each log at the current time, the readers are one record ahead
+  FrameLogReader *readers[2] = {&a, &b};
+  std::vector<FramePixel> frames[2];
+  uint8_t brightness[2] = {0, 0};
+  bool more[2];
+  for(int i = 0; i < 2; i++){
+    readers[i]->rewind();
+    frames[i] = readers[i]->pixels;
+    more[i] = readers[i]->next();
+  }
+  while(more[0] || more[1]){
+    uint32_t now = UINT32_MAX;
+    for(int i = 0; i < 2; i++){
+      if(more[i] && readers[i]->time < now) now = readers[i]->time;
+    }
+    for(int i = 0; i < 2; i++){
+      while(more[i] && readers[i]->time == now){
+        frames[i] = readers[i]->pixels;
+        brightness[i] = readers[i]->brightness;
+        more[i] = readers[i]->next();
+      }
+    }
+    diff.frames++;
+    uint8_t error = abs(brightness[0] - brightness[1]);
+    bool different = error > 0;
+    int firstPixel = -1;
+    for(size_t pixel = 0; pixel < frames[0].size(); pixel++){
+      const FramePixel &pa = frames[0][pixel];
+      const FramePixel &pb = frames[1][pixel];
+      uint8_t channel = abs(pa.r - pb.r);
+      if(abs(pa.g - pb.g) > channel) channel = abs(pa.g - pb.g);
+      if(abs(pa.b - pb.b) > channel) channel = abs(pa.b - pb.b);
+      if(channel > 0){
+        if(!different) firstPixel = pixel;
+        different = true;
+        if(channel > error) error = channel;
+      }
+    }
+    if(different){
+      if(diff.differentFrames == 0){
+        diff.firstTime = now;
+        diff.firstPixel = firstPixel;
+      }
+      diff.differentFrames++;
+      if(error > diff.maxError) diff.maxError = error;
+    }
+  }
+  if(a.error() || b.error()){
+    diff.error = a.error() ? a.error() : b.error();
+  }
+  return diff;
+}
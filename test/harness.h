@@ -0,0 +1,45 @@
+// Shared helpers of the host tests. Include after lichtwecker.cpp, the
+// helpers reach into the globals of the sketch.
+#pragma once
+#include <stdio.h>
+
+static int checksFailed = 0;
+static int checksRun = 0;
+
+#define CHECK(condition) do { \
+  checksRun++; \
+  if(!(condition)){ \
+    checksFailed++; \
+    fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+  } \
+} while(0)
+
+#define CHECK_EQ(a, b) do { \
+  checksRun++; \
+  long long valueA = (long long)(a), valueB = (long long)(b); \
+  if(valueA != valueB){ \
+    checksFailed++; \
+    fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", __FILE__, __LINE__, #a, #b, valueA, valueB); \
+  } \
+} while(0)
+
+//BUSY_PIN follows the fake DFPlayer, every other pin host::pins
+static int readPinWithFakeDFPlayer(uint8_t pin){
+  if(pin == BUSY_PIN) return myDFPlayer.busy() ? LOW : HIGH;
+  return host::pins[pin & 31];
+}
+
+//brings the sketch up like setup(), with the fake DFPlayer on BUSY_PIN
+static void setupHost(){
+  host::pinReader = readPinWithFakeDFPlayer;
+  setup();
+}
+
+static int finishTests(const char *name){
+  if(checksFailed == 0){
+    printf("%s: %d checks passed\n", name, checksRun);
+    return 0;
+  }
+  printf("%s: %d of %d checks failed\n", name, checksFailed, checksRun);
+  return 1;
+}
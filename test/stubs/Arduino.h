@@ -0,0 +1,155 @@
+// Host stand-in for the Arduino core, just enough to run lichtwecker.cpp
+// on a PC. Time only moves when a test or the sketch calls delay().
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <type_traits>
+
+using std::min;
+using std::max;
+
+#define F(x) x
+
+#define D0 16
+#define D1 5
+#define D4 2
+#define D5 14
+#define D6 12
+#define D7 13
+#define D8 15
+
+#define INPUT 0
+#define LOW 0
+#define HIGH 1
+
+namespace host {
+  extern uint32_t now;      //value of millis()
+  extern int pins[32];      //values returned by digitalRead()
+  extern int (*pinReader)(uint8_t pin); //replaces pins when set
+  uint32_t randomRegister();
+}
+
+//hardware random number generator of the ESP8266
+#define RANDOM_REG32 (host::randomRegister())
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+int digitalRead(uint8_t pin);
+void pinMode(uint8_t pin, uint8_t mode);
+
+class String {
+  public:
+    String(const char *text = ""){ s = text; }
+    String(const std::string &text){ s = text; }
+    String(int value){ s = std::to_string(value); }
+    String(unsigned int value){ s = std::to_string(value); }
+    String(long value){ s = std::to_string(value); }
+    String(unsigned long value){ s = std::to_string(value); }
+
+    const char* c_str() const { return s.c_str(); }
+    unsigned int length() const { return s.size(); }
+    char charAt(unsigned int i) const { return i < s.size() ? s[i] : 0; }
+    int indexOf(const char *text) const {
+      size_t found = s.find(text);
+      return found == std::string::npos ? -1 : (int)found;
+    }
+    int indexOf(const String &text) const { return indexOf(text.c_str()); }
+    String substring(unsigned int from) const { return substring(from, s.size()); }
+    String substring(unsigned int from, unsigned int to) const {
+      if(from > s.size()) return String();
+      return String(s.substr(from, std::min<size_t>(to, s.size()) - from));
+    }
+    long toInt() const { return atol(s.c_str()); }
+    void toCharArray(char *buffer, unsigned int size) const {
+      if(size == 0) return;
+      size_t n = std::min<size_t>(size - 1, s.size());
+      memcpy(buffer, s.c_str(), n);
+      buffer[n] = '\0';
+    }
+    void trim(){
+      size_t first = s.find_first_not_of(" \t\r\n");
+      size_t last = s.find_last_not_of(" \t\r\n");
+      s = first == std::string::npos ? "" : s.substr(first, last - first + 1);
+    }
+    void toLowerCase(){ for(auto &c : s) c = tolower(c); }
+    bool startsWith(const char *text) const { return s.compare(0, strlen(text), text) == 0; }
+    bool equals(const char *text) const { return s == text; }
+    bool equals(const String &text) const { return s == text.s; }
+    String& operator+=(const String &text){ s += text.s; return *this; }
+    String& operator+=(const char *text){ s += text; return *this; }
+    String& operator+=(char c){ s += c; return *this; }
+
+  private:
+    std::string s;
+};
+
+class IPAddress {
+  public:
+    IPAddress(){ memset(bytes, 0, 4); }
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d){ bytes[0] = a; bytes[1] = b; bytes[2] = c; bytes[3] = d; }
+    bool operator==(const IPAddress &other) const { return memcmp(bytes, other.bytes, 4) == 0; }
+    uint8_t bytes[4];
+};
+
+class Print {
+  public:
+    virtual ~Print(){}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size){
+      size_t n = 0;
+      while(size--) n += write(*buffer++);
+      return n;
+    }
+    size_t write(const char *buffer, size_t size){ return write((const uint8_t *)buffer, size); }
+
+    size_t print(const char *text){ return write(text, strlen(text)); }
+    size_t print(const String &text){ return print(text.c_str()); }
+    size_t print(char c){ return write((uint8_t)c); }
+    size_t print(const IPAddress &ip){
+      char text[16];
+      snprintf(text, sizeof(text), "%u.%u.%u.%u", ip.bytes[0], ip.bytes[1], ip.bytes[2], ip.bytes[3]);
+      return print(text);
+    }
+    template <typename T>
+    typename std::enable_if<std::is_arithmetic<T>::value, size_t>::type print(T value){
+      return print(std::to_string(value).c_str());
+    }
+    size_t println(){ return print("\r\n"); }
+    template <typename T>
+    size_t println(const T &value){ return print(value) + println(); }
+};
+
+class Stream : public Print {
+  public:
+    virtual int available(){ return 0; }
+    virtual int read(){ return -1; }
+    void setTimeout(unsigned long){}
+    String readStringUntil(char terminator){
+      std::string text;
+      int c;
+      while((c = read()) >= 0 && c != terminator) text += (char)c;
+      return String(text);
+    }
+    size_t readBytes(char *buffer, size_t size){
+      size_t n = 0;
+      int c;
+      while(n < size && (c = read()) >= 0) buffer[n++] = c;
+      return n;
+    }
+    size_t readBytes(uint8_t *buffer, size_t size){ return readBytes((char *)buffer, size); }
+};
+
+//Discards everything, set host::echoSerial to see the diagnostics
+class HardwareSerial : public Stream {
+  public:
+    void begin(unsigned long){}
+    size_t write(uint8_t c);
+    using Print::write;
+};
+extern HardwareSerial Serial;
+namespace host { extern bool echoSerial; }
@@ -0,0 +1,66 @@
+// Fake DFPlayer. Serves a configurable SD-Card, logs every command and counts
+// every query, which would be a round-trip over the SoftwareSerial.
+#pragma once
+#include <deque>
+#include <vector>
+#include "Arduino.h"
+
+#define TimeOut 0
+#define WrongStack 1
+#define DFPlayerCardInserted 2
+#define DFPlayerCardRemoved 3
+#define DFPlayerCardOnline 4
+#define DFPlayerPlayFinished 5
+#define DFPlayerError 6
+
+class DFRobotDFPlayerMini {
+  public:
+    //SD-Card
+    int files = 0;
+    int folders = 0;
+    int folderFiles[100] = {0};
+    //length of every song, BUSY_PIN is LOW while a song plays
+    uint32_t songLength = 0;
+    uint32_t busyUntil = 0;
+
+    int queries = 0;
+    std::vector<std::string> commands;
+    std::vector<uint32_t> commandTimes;
+    std::deque<uint8_t> events;   //reported by available()/readType()
+    uint8_t currentVolume = 0;
+
+    bool begin(Stream &, bool = true, bool = true){ return true; }
+    void volume(uint8_t value){ currentVolume = value; log("volume " + std::to_string(value)); }
+    void play(int track = 1){ log("play " + std::to_string(track)); busyUntil = host::now + songLength; }
+    void playFolder(uint8_t folder, uint8_t track){
+      log("folder " + std::to_string(folder) + "/" + std::to_string(track));
+      busyUntil = host::now + songLength;
+    }
+    void next(){ log("next"); busyUntil = host::now + songLength; }
+    void stop(){ log("stop"); busyUntil = host::now; }
+
+    int readFileCounts(){ queries++; return files; }
+    int readFolderCounts(){ queries++; return folders; }
+    int readFileCountsInFolder(int folder){ queries++; return folder < 100 ? folderFiles[folder] : -1; }
+
+    bool available(){ return !events.empty(); }
+    uint8_t readType(){
+      uint8_t type = events.front();
+      events.pop_front();
+      return type;
+    }
+    int read(){ return 0; }
+
+    bool busy() const { return host::now < busyUntil; }
+    int countCommands(const char *prefix) const {
+      int count = 0;
+      for(const auto &command : commands) if(command.compare(0, strlen(prefix), prefix) == 0) count++;
+      return count;
+    }
+
+  private:
+    void log(const std::string &command){
+      commands.push_back(command);
+      commandTimes.push_back(host::now);
+    }
+};
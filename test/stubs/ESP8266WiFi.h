@@ -0,0 +1,63 @@
+// Host stand-in for the WiFi of the ESP8266. A test hands a request to the
+// sketch with host::connect() and reads the answer from the connection.
+#pragma once
+#include <memory>
+#include "Arduino.h"
+
+#define WIFI_STA 1
+#define WL_CONNECTED 3
+
+struct HostConnection {
+  std::string input;
+  size_t position = 0;
+  std::string output;
+  bool open = true;
+};
+
+class WiFiClient : public Stream {
+  public:
+    WiFiClient(){}
+    explicit WiFiClient(std::shared_ptr<HostConnection> connection) : connection(connection){}
+    operator bool() const { return (bool)connection; }
+    bool connected(){ return connection && connection->open; }
+    int available(){ return connection ? connection->input.size() - connection->position : 0; }
+    int read(){
+      if(!connection || connection->position >= connection->input.size()) return -1;
+      return (uint8_t)connection->input[connection->position++];
+    }
+    size_t write(uint8_t c){ if(connection) connection->output += (char)c; return 1; }
+    size_t write(const uint8_t *buffer, size_t size){
+      if(connection) connection->output.append((const char *)buffer, size);
+      return size;
+    }
+    using Print::write;
+    void stop(){ if(connection) connection->open = false; }
+
+  private:
+    std::shared_ptr<HostConnection> connection;
+};
+
+namespace host {
+  extern std::shared_ptr<HostConnection> pendingConnection;
+  std::shared_ptr<HostConnection> connect(const std::string &request);
+}
+
+class WiFiServer {
+  public:
+    WiFiServer(uint16_t){}
+    void begin(){}
+    WiFiClient available(){
+      WiFiClient client(host::pendingConnection);
+      host::pendingConnection.reset();
+      return client;
+    }
+};
+
+class WiFiClass {
+  public:
+    void mode(int){}
+    void begin(const char *, const char *){}
+    int status(){ return WL_CONNECTED; }
+    IPAddress localIP(){ return IPAddress(192, 168, 1, 10); }
+};
+extern WiFiClass WiFi;
@@ -0,0 +1,107 @@
+// Host stand-in for FastLED. The 8 bit math and the random numbers follow
+// lib8tion, so effects render the same frames as on the NodeMCU.
+#pragma once
+#include "Arduino.h"
+
+typedef uint8_t fract8;
+
+struct CRGB {
+  enum HTMLColorCode {
+    Amethyst = 0x9966CC,
+    Aqua = 0x00FFFF,
+    Black = 0x000000,
+    BurlyWood = 0xDEB887,
+    Gold = 0xFFD700,
+    Green = 0x008000,
+    LemonChiffon = 0xFFFACD,
+    Red = 0xFF0000,
+    RosyBrown = 0xBC8F8F,
+    RoyalBlue = 0x4169E1
+  };
+
+  uint8_t r, g, b;
+
+  CRGB() : r(0), g(0), b(0){}
+  CRGB(uint8_t red, uint8_t green, uint8_t blue) : r(red), g(green), b(blue){}
+  CRGB(uint32_t code) : r(code >> 16), g(code >> 8), b(code){}
+  bool operator==(const CRGB &other) const { return r == other.r && g == other.g && b == other.b; }
+  bool operator!=(const CRGB &other) const { return !(*this == other); }
+};
+
+struct TProgmemRGBPalette16 {};
+extern const TProgmemRGBPalette16 HeatColors_p;
+CRGB ColorFromPalette(const TProgmemRGBPalette16 &palette, uint8_t index);
+
+uint8_t scale8(uint8_t i, fract8 scale);
+uint8_t scale8_video(uint8_t i, fract8 scale);
+uint8_t qadd8(uint8_t i, uint8_t j);
+uint8_t lerp8by8(uint8_t a, uint8_t b, fract8 frac);
+uint8_t ease8InOutQuad(uint8_t i);
+uint8_t blend8(uint8_t a, uint8_t b, uint8_t amountOfB);
+
+void random16_set_seed(uint16_t seed);
+uint16_t random16_get_seed();
+void random16_add_entropy(uint16_t entropy);
+uint16_t random16();
+uint16_t random16(uint16_t lim);
+uint8_t random8();
+uint8_t random8(uint8_t lim);
+uint8_t random8(uint8_t min, uint8_t lim);
+
+void fill_solid(CRGB *leds, int count, const CRGB &color);
+CRGB* nblend(CRGB *existing, const CRGB *overlay, uint16_t count, fract8 amountOfOverlay);
+
+enum { TypicalSMD5050 = 0xFFB0F0 };
+enum { RGB, GRB };
+enum { WS2812B };
+
+class CLEDController {
+  public:
+    CLEDController& setCorrection(uint32_t){ return *this; }
+};
+
+class CFastLED {
+  public:
+    template <int CHIPSET, int DATA_PIN, int COLOR_ORDER>
+    CLEDController& addLeds(CRGB *data, int count){
+      leds = data;
+      size = count;
+      return controller;
+    }
+    void setBrightness(uint8_t value){ brightness = value; }
+    uint8_t getBrightness(){ return brightness; }
+    void clear(bool writeData = false){
+      if(leds) fill_solid(leds, size, CRGB::Black);
+      if(writeData) show();
+    }
+    void show(){ shows++; }
+    void delay(unsigned long ms){ show(); ::delay(ms); }
+
+    CRGB *leds = nullptr;
+    int size = 0;
+    uint8_t brightness = 255;
+    uint32_t shows = 0;   //frames sent to the matrix
+
+  private:
+    CLEDController controller;
+};
+extern CFastLED FastLED;
+
+//Same behaviour as CEveryNMillis: first trigger one period after construction
+class CEveryNMillis {
+  public:
+    CEveryNMillis(uint32_t period) : period(period), previous(millis()){}
+    bool ready(){
+      if(millis() - previous < period) return false;
+      previous = millis();
+      return true;
+    }
+  private:
+    uint32_t period;
+    uint32_t previous;
+};
+
+#define EVERY_N_CONCAT2(a, b) a##b
+#define EVERY_N_CONCAT(a, b) EVERY_N_CONCAT2(a, b)
+#define EVERY_N_MILLISECONDS(n) static CEveryNMillis EVERY_N_CONCAT(everyN, __LINE__)(n); if(EVERY_N_CONCAT(everyN, __LINE__).ready())
+#define EVERY_N_SECONDS(n) EVERY_N_MILLISECONDS((n) * 1000UL)
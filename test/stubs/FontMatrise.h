@@ -0,0 +1,3 @@
+#pragma once
+#include <stdint.h>
+const uint8_t MatriseFontData[] = {0};
@@ -0,0 +1,55 @@
+// Host stand-in for LEDMatrix with the drawing functions the sketch uses.
+// A VERTICAL_MATRIX stores one column after the other.
+#pragma once
+#include "FastLED.h"
+
+enum MatrixType_t { HORIZONTAL_MATRIX, VERTICAL_MATRIX };
+
+template <int W, int H, MatrixType_t T>
+class cLEDMatrix {
+  public:
+    CRGB* operator[](int n){ return &m_LED[n]; }
+    int Size(){ return W * H; }
+    int Width(){ return W; }
+    int Height(){ return H; }
+
+    void SetPixel(int x, int y, CRGB col){
+      if(x >= 0 && x < W && y >= 0 && y < H) m_LED[T == VERTICAL_MATRIX ? x * H + y : y * W + x] = col;
+    }
+    void DrawLine(int x0, int y0, int x1, int y1, CRGB col){
+      int dx = abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+      int dy = -abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+      int err = dx + dy;
+      while(true){
+        SetPixel(x0, y0, col);
+        if(x0 == x1 && y0 == y1) break;
+        int e2 = 2 * err;
+        if(e2 >= dy){ err += dy; x0 += sx; }
+        if(e2 <= dx){ err += dx; y0 += sy; }
+      }
+    }
+    void DrawRectangle(int x0, int y0, int x1, int y1, CRGB col){
+      DrawLine(x0, y0, x1, y0, col);
+      DrawLine(x1, y0, x1, y1, col);
+      DrawLine(x1, y1, x0, y1, col);
+      DrawLine(x0, y1, x0, y0, col);
+    }
+    void DrawFilledRectangle(int x0, int y0, int x1, int y1, CRGB col){
+      for(int x = std::min(x0, x1); x <= std::max(x0, x1); x++) DrawLine(x, y0, x, y1, col);
+    }
+    void DrawCircle(int xc, int yc, int r, CRGB col){
+      int x = -r, y = 0, err = 2 - 2 * r;
+      do {
+        SetPixel(xc - x, yc + y, col);
+        SetPixel(xc - y, yc - x, col);
+        SetPixel(xc + x, yc - y, col);
+        SetPixel(xc + y, yc + x, col);
+        int e2 = err;
+        if(e2 <= y){ err += ++y * 2 + 1; }
+        if(e2 > x || err > y){ err += ++x * 2 + 1; }
+      } while(x < 0);
+    }
+
+  private:
+    CRGB m_LED[W * H];
+};
@@ -0,0 +1,52 @@
+// Host stand-in for LEDText. There is no font, every character is drawn as a
+// fixed 5 column bit pattern, which is enough to tell the frames apart.
+#pragma once
+#include "LEDMatrix.h"
+
+#define COLR_RGB 0x01
+#define COLR_SINGLE 0x10
+
+class cLEDText {
+  public:
+    void SetFont(const uint8_t *){}
+    template <class M>
+    void Init(M *matrix, int width, int height, int x, int y){
+      this->matrix = matrix;
+      this->width = width;
+      this->height = height;
+      setPixel = [](void *m, int px, int py, CRGB col){ static_cast<M *>(m)->SetPixel(px, py, col); };
+      (void)x;
+      (void)y;
+    }
+    int FontHeight(){ return 6; }
+    void SetTextColrOptions(uint16_t, uint8_t r, uint8_t g, uint8_t b){ color = CRGB(r, g, b); }
+    void SetText(unsigned char *text, uint16_t length){
+      this->text = text;
+      this->length = length;
+      position = 0;
+    }
+    int UpdateText(){
+      if(text == nullptr || position > length * 6 + width) return -1;
+      for(int x = 0; x < width; x++){
+        int column = position + x - width;
+        if(column < 0 || column >= length * 6 || column % 6 == 5) continue;
+        uint8_t c = text[column / 6];
+        uint8_t bits = c == ' ' ? 0 : (uint8_t)((c * 37 + (column % 6) * 11) ^ (c << (column % 6))) & 0x3F;
+        for(int y = 0; y < height - 1; y++){
+          if(bits & (1 << y)) setPixel(matrix, x, y, color);
+        }
+      }
+      position++;
+      return 0;
+    }
+
+  private:
+    void *matrix = nullptr;
+    void (*setPixel)(void *, int, int, CRGB) = nullptr;
+    int width = 0;
+    int height = 0;
+    unsigned char *text = nullptr;
+    int length = 0;
+    int position = 0;
+    CRGB color;
+};
@@ -0,0 +1,16 @@
+// Host stand-in for NTPtimeESP, never gets a valid time.
+#pragma once
+#include "ESP8266WiFi.h"
+
+struct strDateTime {
+  uint8_t hour;
+  uint8_t minute;
+  uint8_t second;
+  bool valid;
+};
+
+class NTPtime {
+  public:
+    NTPtime(const char *){}
+    strDateTime getNTPtime(float, int){ strDateTime invalid = {0, 0, 0, false}; return invalid; }
+};
@@ -0,0 +1,10 @@
+#pragma once
+#include "Arduino.h"
+
+class SoftwareSerial : public Stream {
+  public:
+    SoftwareSerial(uint8_t, uint8_t){}
+    void begin(unsigned long){}
+    size_t write(uint8_t){ return 1; }
+    using Print::write;
+};
@@ -0,0 +1,58 @@
+// Host stand-in for WiFiUDP. Received packets are queued by the test,
+// sent packets are kept for the test to deliver or check.
+#pragma once
+#include <deque>
+#include <vector>
+#include "ESP8266WiFi.h"
+
+struct HostPacket {
+  std::vector<uint8_t> data;
+  IPAddress ip;
+  uint16_t port = 0;
+  bool multicast = false;
+};
+
+class WiFiUDP : public Stream {
+  public:
+    std::deque<HostPacket> received;
+    std::vector<HostPacket> sent;
+
+    uint8_t beginMulticast(IPAddress, IPAddress, uint16_t){ return 1; }
+    int parsePacket(){
+      if(received.empty()) return 0;
+      current = received.front();
+      received.pop_front();
+      position = 0;
+      return current.data.size();
+    }
+    int read(uint8_t *buffer, size_t size){
+      size_t n = 0;
+      while(n < size && position < current.data.size()) buffer[n++] = current.data[position++];
+      return n;
+    }
+    int read(){ return position < current.data.size() ? current.data[position++] : -1; }
+    IPAddress remoteIP(){ return current.ip; }
+    uint16_t remotePort(){ return current.port; }
+
+    int beginPacket(IPAddress ip, uint16_t port){ return begin(ip, port, false); }
+    int beginPacketMulticast(IPAddress ip, uint16_t port, IPAddress, int = 1){ return begin(ip, port, true); }
+    size_t write(uint8_t c){ outgoing.data.push_back(c); return 1; }
+    size_t write(const uint8_t *buffer, size_t size){
+      outgoing.data.insert(outgoing.data.end(), buffer, buffer + size);
+      return size;
+    }
+    using Print::write;
+    int endPacket(){ sent.push_back(outgoing); return 1; }
+
+  private:
+    int begin(IPAddress ip, uint16_t port, bool multicast){
+      outgoing = HostPacket();
+      outgoing.ip = ip;
+      outgoing.port = port;
+      outgoing.multicast = multicast;
+      return 1;
+    }
+    HostPacket current;
+    HostPacket outgoing;
+    size_t position = 0;
+};
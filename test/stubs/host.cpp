@@ -0,0 +1,100 @@
+// State and library functions behind the host stubs.
+#include "ESP8266WiFi.h"
+#include "FastLED.h"
+
+namespace host {
+  uint32_t now = 0;
+  int pins[32] = {0};
+  int (*pinReader)(uint8_t pin) = nullptr;
+  bool echoSerial = false;
+  std::shared_ptr<HostConnection> pendingConnection;
+
+  std::shared_ptr<HostConnection> connect(const std::string &request){
+    pendingConnection = std::make_shared<HostConnection>();
+    pendingConnection->input = request;
+    return pendingConnection;
+  }
+}
+
+//unlike the real register it follows the clock, boots at another time differ
+uint32_t host::randomRegister(){
+  uint32_t value = micros() ^ 0x9E3779B9;
+  value ^= value >> 16;
+  value *= 0x85EBCA6B;
+  value ^= value >> 13;
+  value *= 0xC2B2AE35;
+  value ^= value >> 16;
+  return value;
+}
+
+unsigned long millis(){ return host::now; }
+unsigned long micros(){ return host::now * 1000UL; }
+void delay(unsigned long ms){ host::now += ms; }
+int digitalRead(uint8_t pin){
+  if(host::pinReader) return host::pinReader(pin);
+  return host::pins[pin & 31];
+}
+void pinMode(uint8_t, uint8_t){}
+
+size_t HardwareSerial::write(uint8_t c){
+  if(host::echoSerial) fputc(c, stderr);
+  return 1;
+}
+HardwareSerial Serial;
+WiFiClass WiFi;
+CFastLED FastLED;
+const TProgmemRGBPalette16 HeatColors_p = {};
+
+//lib8tion, FASTLED_SCALE8_FIXED
+uint8_t scale8(uint8_t i, fract8 scale){ return ((uint16_t)i * (1 + (uint16_t)scale)) >> 8; }
+uint8_t scale8_video(uint8_t i, fract8 scale){ return (((int)i * (int)scale) >> 8) + ((i && scale) ? 1 : 0); }
+uint8_t qadd8(uint8_t i, uint8_t j){ unsigned int t = i + j; return t > 255 ? 255 : t; }
+uint8_t lerp8by8(uint8_t a, uint8_t b, fract8 frac){
+  if(b > a) return a + scale8(b - a, frac);
+  return a - scale8(a - b, frac);
+}
+uint8_t ease8InOutQuad(uint8_t i){
+  uint8_t j = i;
+  if(j & 0x80) j = 255 - j;
+  uint8_t jj = scale8(j, j);
+  uint8_t jj2 = jj << 1;
+  if(i & 0x80) jj2 = 255 - jj2;
+  return jj2;
+}
+uint8_t blend8(uint8_t a, uint8_t b, uint8_t amountOfB){
+  uint16_t partial = (a << 8) | b;
+  partial += (b * amountOfB);
+  partial -= (a * amountOfB);
+  return partial >> 8;
+}
+
+static uint16_t rand16seed = 1337;
+void random16_set_seed(uint16_t seed){ rand16seed = seed; }
+uint16_t random16_get_seed(){ return rand16seed; }
+void random16_add_entropy(uint16_t entropy){ rand16seed += entropy; }
+uint16_t random16(){ rand16seed = (rand16seed * 2053) + 13849; return rand16seed; }
+uint16_t random16(uint16_t lim){ return ((uint32_t)random16() * lim) >> 16; }
+uint8_t random8(){ rand16seed = (rand16seed * 2053) + 13849; return (uint8_t)(((uint8_t)rand16seed) + ((uint8_t)(rand16seed >> 8))); }
+uint8_t random8(uint8_t lim){ return ((uint16_t)random8() * lim) >> 8; }
+uint8_t random8(uint8_t min, uint8_t lim){ return random8(lim - min) + min; }
+
+void fill_solid(CRGB *leds, int count, const CRGB &color){
+  for(int i = 0; i < count; i++) leds[i] = color;
+}
+CRGB* nblend(CRGB *existing, const CRGB *overlay, uint16_t count, fract8 amountOfOverlay){
+  for(uint16_t i = 0; i < count; i++){
+    if(amountOfOverlay == 0) continue;
+    if(amountOfOverlay == 255){ existing[i] = overlay[i]; continue; }
+    existing[i].r = blend8(existing[i].r, overlay[i].r, amountOfOverlay);
+    existing[i].g = blend8(existing[i].g, overlay[i].g, amountOfOverlay);
+    existing[i].b = blend8(existing[i].b, overlay[i].b, amountOfOverlay);
+  }
+  return existing;
+}
+
+//HeatColors_p from black over red and yellow to white
+CRGB ColorFromPalette(const TProgmemRGBPalette16 &, uint8_t index){
+  if(index < 85) return CRGB(index * 3, 0, 0);
+  if(index < 170) return CRGB(255, (index - 85) * 3, 0);
+  return CRGB(255, 255, (index - 170) * 3);
+}
@@ -0,0 +1,115 @@
+// JSON API: status codes, ETags and batched alarm updates.
+#include "../lichtwecker.cpp"
+#include "harness.h"
+
+//sends one request through controlWebsite() and returns the whole answer
+static std::shared_ptr<HostConnection> request(const std::string &head, const std::string &body = ""){
+  std::shared_ptr<HostConnection> connection = host::connect(head + "\r\n\r\n" + body);
+  controlWebsite();
+  return connection;
+}
+
+static bool hasStatus(const std::shared_ptr<HostConnection> &connection, const char *status){
+  return connection->output.compare(0, 9 + strlen(status), std::string("HTTP/1.1 ") + status) == 0;
+}
+
+static std::string etagOf(const std::shared_ptr<HostConnection> &connection){
+  size_t start = connection->output.find("ETag: ");
+  if(start == std::string::npos) return "";
+  start += 6;
+  return connection->output.substr(start, connection->output.find("\r\n", start) - start);
+}
+
+static void testNegativeContentLengthIsRejected(){
+  const std::string body = "{\"hour\":5}";
+  std::shared_ptr<HostConnection> connection =
+    request("PUT /api/alarms HTTP/1.1\r\nContent-Length: -1", body);
+  CHECK(hasStatus(connection, "400"));
+  //the body is left alone
+  CHECK_EQ(connection->input.size() - connection->position, body.size());
+  CHECK(alarmHour != 5);
+}
+
+static void testLargeBodyIsRejected(){
+  std::shared_ptr<HostConnection> connection =
+    request("PUT /api/alarms HTTP/1.1\r\nContent-Length: 100000", "{}");
+  CHECK(hasStatus(connection, "413"));
+}
+
+static void testStateHonoursETag(){
+  std::shared_ptr<HostConnection> first = request("GET /api/state HTTP/1.1");
+  CHECK(hasStatus(first, "200"));
+  CHECK(first->output.find("\"phase\":\"idle\"") != std::string::npos);
+  std::string etag = etagOf(first);
+  CHECK(!etag.empty());
+
+  std::shared_ptr<HostConnection> second = request("GET /api/state HTTP/1.1\r\nIf-None-Match: " + etag);
+  CHECK(hasStatus(second, "304"));
+
+  //a changed state gets a new ETag
+  alarmMinute = (alarmMinute + 1) % 60;
+  std::shared_ptr<HostConnection> third = request("GET /api/state HTTP/1.1\r\nIf-None-Match: " + etag);
+  CHECK(hasStatus(third, "200"));
+  CHECK(etagOf(third) != etag);
+}
+
+static std::shared_ptr<HostConnection> putAlarms(const std::string &batch){
+  return request("PUT /api/alarms HTTP/1.1\r\nContent-Length: " + std::to_string(batch.size()), batch);
+}
+
+//06:31 and 07:00 gave the same value in a hash of hour * 31 + minute
+static void testEveryChangeGetsANewETag(){
+  std::shared_ptr<HostConnection> before = putAlarms("{\"hour\":6,\"minute\":31}");
+  CHECK(hasStatus(before, "200"));
+  std::string etag = etagOf(before);
+
+  std::shared_ptr<HostConnection> after = putAlarms("{\"hour\":7,\"minute\":0}");
+  CHECK(hasStatus(after, "200"));
+  CHECK(etagOf(after) != etag);
+  std::shared_ptr<HostConnection> poll = request("GET /api/state HTTP/1.1\r\nIf-None-Match: " + etag);
+  CHECK(hasStatus(poll, "200"));
+  CHECK(poll->output.find("\"hour\":7,\"minute\":0") != std::string::npos);
+
+  //the website changes the alarm without the API
+  etag = etagOf(poll);
+  alarmHour = 6;
+  alarmMinute = 31;
+  CHECK(hasStatus(request("GET /api/state HTTP/1.1\r\nIf-None-Match: " + etag), "200"));
+}
+
+static void testAlarmsAreUpdatedTogether(){
+  const std::string batch = "{\"hour\":6,\"minute\":45,\"folder\":2,\"shuffle\":true}";
+  std::shared_ptr<HostConnection> connection =
+    request("PUT /api/alarms HTTP/1.1\r\nContent-Length: " + std::to_string(batch.size()), batch);
+  CHECK(hasStatus(connection, "200"));
+  CHECK_EQ(alarmHour, 6);
+  CHECK_EQ(alarmMinute, 45);
+  CHECK_EQ(alarmFolder, 2);
+  CHECK(alarmShuffle);
+
+  //one invalid field and nothing is applied
+  const std::string invalid = "{\"hour\":7,\"minute\":61}";
+  connection = request("PUT /api/alarms HTTP/1.1\r\nContent-Length: " + std::to_string(invalid.size()), invalid);
+  CHECK(hasStatus(connection, "400"));
+  CHECK_EQ(alarmHour, 6);
+  CHECK_EQ(alarmMinute, 45);
+}
+
+static void testStartAndStop(){
+  CHECK(hasStatus(request("POST /api/alarm/start HTTP/1.1"), "204"));
+  CHECK(wakeUpProcessStarted);
+  CHECK(hasStatus(request("POST /api/alarm/stop HTTP/1.1"), "204"));
+  CHECK(!wakeUpProcessStarted);
+  CHECK(hasStatus(request("GET /api/nothing HTTP/1.1"), "404"));
+}
+
+int main(){
+  setupHost();
+  testNegativeContentLengthIsRejected();
+  testLargeBodyIsRejected();
+  testStateHonoursETag();
+  testEveryChangeGetsANewETag();
+  testAlarmsAreUpdatedTogether();
+  testStartAndStop();
+  return finishTests("test_api");
+}
@@ -0,0 +1,50 @@
+// Effect pipeline: the registry draws the same frames as calling the effects
+// directly. The time per frame is measured by bench_effects (make bench).
+#include "../lichtwecker.cpp"
+#include "harness.h"
+
+//the path before the registry, one call per phase
+static void renderDirect(uint8_t phase){
+  switch(phase){
+    case PHASE_IDLE:      FastLED.clear(); break;
+    case PHASE_SUNRISE:   showSunrise(); break;
+    case PHASE_COUNTDOWN: showCountdown(); break;
+    case PHASE_FIRE:      showFireAnimation(); break;
+  }
+}
+
+static void startTimeline(){
+  stopWakeUpProcess();
+  wakeUpProcessStarted = true;
+  controlSequenceTimeline();
+  host::now += 5 * SUNRISE_STEP_DELAY + 50; //the sun is on its way up
+}
+
+static void testRegistryDrawsTheSameFrames(){
+  const WakeupPhase phases[] = {PHASE_IDLE, PHASE_SUNRISE, PHASE_FIRE};
+  for(WakeupPhase phase : phases){
+    startTimeline();
+    random16_set_seed(1234);
+    renderDirect(phase);
+    CRGB direct[NUM_LEDS];
+    memcpy(direct, leds[0], sizeof(direct));
+
+    random16_set_seed(1234);
+    WakeupEffects::render(phase);
+    CHECK(memcmp(direct, leds[0], sizeof(direct)) == 0);
+  }
+}
+
+static void testRenderTimeIsOnTheWebsite(){
+  effectRenderMicros = 4321;
+  std::shared_ptr<HostConnection> connection = host::connect("GET / HTTP/1.1\r\n\r\n");
+  controlWebsite();
+  CHECK(connection->output.find("effect render time: 4321 us") != std::string::npos);
+}
+
+int main(){
+  setupHost();
+  testRegistryDrawsTheSameFrames();
+  testRenderTimeIsOnTheWebsite();
+  return finishTests("test_effects");
+}
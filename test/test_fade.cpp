@@ -0,0 +1,97 @@
+// Fade of brightness and volume, counts the volume commands per ramp.
+#include "../lichtwecker.cpp"
+#include "harness.h"
+
+static void testCurvesReachTheirEnds(){
+  const FadeCurve curves[] = {FADE_LINEAR, FADE_EASE_IN, FADE_EASE_IN_OUT};
+  for(FadeCurve curve : curves){
+    CHECK_EQ(applyFadeCurve(0, curve), 0);
+    CHECK_EQ(applyFadeCurve(255, curve), 255);
+    uint8_t previous = 0;
+    bool rising = true;
+    for(int progress = 0; progress < 256; progress++){
+      uint8_t value = applyFadeCurve(progress, curve);
+      rising &= value >= previous;
+      previous = value;
+    }
+    CHECK(rising);
+  }
+}
+
+/*
+Runs one ramp from the start of the alarm to the end of the fade and returns
+the number of volume commands. frameTime is the time per loop.
+*/
+static int runRamp(uint32_t frameTime){
+  stopWakeUpProcess();
+  updateDFPlayerVolume(); //resets the volume of the last ramp
+  host::now += 1000;
+  myDFPlayer.commands.clear();
+  myDFPlayer.commandTimes.clear();
+
+  wakeUpProcessStarted = true;
+  controlSequenceTimeline();
+  uint32_t end = host::now + FADE_DURATION + 2000;
+  while(host::now < end){
+    controlFade();
+    updateDFPlayerVolume();
+    host::now += frameTime;
+  }
+  return myDFPlayer.countCommands("volume");
+}
+
+static void testOneCommandPerVolumeLevel(){
+  //every level between start and end is sent exactly once
+  CHECK_EQ(runRamp(FPS_DELAY), VOLUME - VOLUME_START);
+  CHECK_EQ(myDFPlayer.currentVolume, VOLUME);
+  CHECK_EQ(FastLED.getBrightness(), BRIGHTNESS_END);
+
+  //a faster loop does not send more commands
+  CHECK_EQ(runRamp(5), VOLUME - VOLUME_START);
+}
+
+static void testCommandsKeepTheirGap(){
+  runRamp(5);
+  bool gapsKept = true;
+  for(size_t i = 1; i < myDFPlayer.commandTimes.size(); i++){
+    gapsKept &= myDFPlayer.commandTimes[i] - myDFPlayer.commandTimes[i - 1] >= DFPLAYER_COMMAND_GAP;
+  }
+  CHECK(gapsKept);
+}
+
+static void testLevelsAreMergedWhileWaiting(){
+  //a ramp shorter than the gap ends up in a single command
+  stopWakeUpProcess();
+  updateDFPlayerVolume();
+  host::now += 1000;
+  myDFPlayer.commands.clear();
+  lastDFPlayerCommand = millis();
+  fadeVolume = VOLUME_START + 1;
+  updateDFPlayerVolume();
+  fadeVolume = VOLUME_START + 2;
+  updateDFPlayerVolume();
+  fadeVolume = VOLUME_START + 3;
+  host::now += DFPLAYER_COMMAND_GAP;
+  updateDFPlayerVolume();
+  CHECK_EQ(myDFPlayer.countCommands("volume"), 1);
+  CHECK_EQ(myDFPlayer.currentVolume, VOLUME_START + 3);
+}
+
+static void testStopRestoresClock(){
+  runRamp(FPS_DELAY);
+  stopWakeUpProcess();
+  CHECK_EQ(FastLED.getBrightness(), BRIGHTNESS);
+  host::now += DFPLAYER_COMMAND_GAP;
+  updateDFPlayerVolume();
+  CHECK_EQ(myDFPlayer.currentVolume, VOLUME_START);
+}
+
+int main(){
+  setupHost();
+  testCurvesReachTheirEnds();
+  testOneCommandPerVolumeLevel();
+  testCommandsKeepTheirGap();
+  testLevelsAreMergedWhileWaiting();
+  testStopRestoresClock();
+  return finishTests("test_fade");
+}
@@ -0,0 +1,136 @@
+// Golden frame logs. Built once per phase with FRAME_CAPTURE_PHASE, runs the
+// loop with the fake DFPlayer and compares the recording with
+// golden/<phase>.lwfl. UPDATE_GOLDEN=1 in the environment (make golden)
+// writes the recording instead, after a change of the look was intended.
+#include "../lichtwecker.cpp"
+#include "harness.h"
+#include "framelog.h"
+
+#ifndef GOLDEN_MAX_ERROR
+#define GOLDEN_MAX_ERROR 0      //largest difference of a color channel, 0 = pixel exact
+#endif
+#define GOLDEN_SONG_LENGTH 15000 //every song on the fake SD-Card
+#define GOLDEN_FIRE_FRAMES 100  //the fire never ends, the recording does
+#define GOLDEN_MAX_FRAMES  3000
+
+static const char *goldenName(){
+  switch(FRAME_CAPTURE_PHASE){
+    case PHASE_SUNRISE: return "sunrise";
+    case PHASE_COUNTDOWN: return "countdown";
+    case PHASE_FIRE: return "fire";
+    default: return "clock";
+  }
+}
+
+//one loop with a button held down
+static void pressButton(uint8_t pin){
+  host::pins[pin] = HIGH;
+  loop();
+  host::pins[pin] = LOW;
+}
+
+/*
+The clock is recorded from the showtime button until the time has scrolled
+through. Every other phase from the start of the alarm until the phase is
+over.
+*/
+static void runPhase(){
+  uint32_t frames = 0;
+  if(FRAME_CAPTURE_PHASE == PHASE_IDLE){
+    pressButton(BUTTON_SHOWTIME_PIN);
+    while(buttonShowTimePressed && frames++ < GOLDEN_MAX_FRAMES){
+      loop();
+    }
+    loop(); //records the last frame of the clock
+    return;
+  }
+
+  pressButton(BUTTON_START_PIN);
+  bool reached = false;
+  uint32_t framesInPhase = 0;
+  while(frames++ < GOLDEN_MAX_FRAMES){
+    WakeupPhase phase = currentWakeupPhase();
+    if(phase == FRAME_CAPTURE_PHASE){
+      reached = true;
+      framesInPhase++;
+    } else if(reached){
+      return;
+    }
+    if(framesInPhase > GOLDEN_FIRE_FRAMES && phase == PHASE_FIRE){
+      return;
+    }
+    loop();
+  }
+}
+
+static bool writeGolden(const char *path){
+  FILE *file = fopen(path, "wb");
+  if(!file) return false;
+  bool written = fwrite(captureLog, 1, captureLength, file) == captureLength;
+  return fclose(file) == 0 && written;
+}
+
+//the recording follows the frames, however long the loops took
+static void testRecordingIsOnTheFrameTimeline(){
+  FrameLogReader recording;
+  CHECK(recording.attach(captureLog, captureLength));
+  CHECK_EQ(recording.width, MATRIX_WIDTH);
+  CHECK_EQ(recording.height, MATRIX_HEIGHT);
+  CHECK_EQ(recording.fps, FPS);
+
+  bool onlyThisPhase = true;
+  bool onFrames = true;
+  bool rising = true;
+  uint32_t previous = 0;
+  while(recording.next()){
+    onlyThisPhase &= recording.phase == FRAME_CAPTURE_PHASE;
+    onFrames &= recording.time % FPS_DELAY == 0;
+    rising &= recording.recordsRead() == 1 || recording.time > previous;
+    previous = recording.time;
+  }
+  CHECK(recording.error() == NULL);
+  CHECK(recording.recordsRead() > 10);
+  CHECK(captureLength < FRAME_CAPTURE_SIZE - 4 * NUM_LEDS); //not cut off
+  CHECK(onlyThisPhase);
+  CHECK(onFrames);
+  CHECK(rising);
+}
+
+static void testRecordingMatchesGolden(){
+  char path[64];
+  snprintf(path, sizeof(path), "golden/%s.lwfl", goldenName());
+  if(getenv("UPDATE_GOLDEN")){
+    CHECK(writeGolden(path));
+    printf("test_golden: wrote %s, %u bytes\n", path, captureLength);
+    return;
+  }
+
+  FrameLogReader golden, recording;
+  if(!golden.map(path)){
+    fprintf(stderr, "%s: %s, run make golden to record it\n", path, golden.error());
+    CHECK(false);
+    return;
+  }
+  CHECK(recording.attach(captureLog, captureLength));
+  FrameLogDiff diff = compareFrameLogs(golden, recording);
+  CHECK(diff.error == NULL);
+  CHECK(diff.frames > 0);
+  if(diff.maxError > GOLDEN_MAX_ERROR){
+    fprintf(stderr, "%s: %zu of %zu frames differ, first at %u ms in pixel %d, largest error %u\n",
+      path, diff.differentFrames, diff.frames, diff.firstTime, diff.firstPixel, diff.maxError);
+  }
+  CHECK(diff.maxError <= GOLDEN_MAX_ERROR);
+}
+
+int main(){
+  myDFPlayer.files = 5;
+  myDFPlayer.songLength = GOLDEN_SONG_LENGTH;
+  setupHost();
+  runPhase();
+  testRecordingIsOnTheFrameTimeline();
+  testRecordingMatchesGolden();
+
+  char name[32];
+  snprintf(name, sizeof(name), "test_golden %s", goldenName());
+  return finishTests(name);
+}
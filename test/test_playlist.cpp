@@ -0,0 +1,151 @@
+// Track index and Phase 3 playlist against the fake DFPlayer.
+#include "../lichtwecker.cpp"
+#include "harness.h"
+
+#include <vector>
+
+static std::vector<uint16_t> currentPlaylist(){
+  return std::vector<uint16_t>(playlist, playlist + playlistLength);
+}
+
+static void testTrackIndexIsReadOnce(){
+  CHECK_EQ(trackCount, 20);
+  CHECK_EQ(folderCount, 2);
+  CHECK_EQ(folderTrackCounts[1], 5);
+  CHECK_EQ(folderTrackCounts[2], 7);
+  CHECK_EQ(folderTrackCounts[3], 0);
+  //files, folders and one query per folder
+  CHECK_EQ(myDFPlayer.queries, 4);
+}
+
+static void testRootPlaylistSkipsSunriseAndCountdown(){
+  alarmFolder = 0;
+  alarmShuffle = false;
+  buildPlaylist();
+  CHECK_EQ(playlistFolder, 0);
+  CHECK_EQ(playlistLength, 18);
+  CHECK_EQ(playlist[0], FIRST_PLAYLIST_TRACK);
+  CHECK_EQ(playlist[17], 20);
+}
+
+static void testFolderPlaylist(){
+  alarmFolder = 2;
+  alarmShuffle = false;
+  buildPlaylist();
+  CHECK_EQ(playlistFolder, 2);
+  CHECK_EQ(playlistLength, 7);
+  CHECK_EQ(playlist[0], 1);
+  CHECK_EQ(playlist[6], 7);
+
+  //an empty or unknown folder falls back to every song
+  alarmFolder = 5;
+  buildPlaylist();
+  CHECK_EQ(playlistFolder, 0);
+  CHECK_EQ(playlistLength, 18);
+}
+
+static void testShuffleIsPermutation(){
+  alarmFolder = 0;
+  alarmShuffle = false;
+  buildPlaylist();
+  std::vector<uint16_t> ordered = currentPlaylist();
+
+  alarmShuffle = true;
+  bool anyShuffled = false;
+  for(int i = 0; i < 4; i++){
+    host::now += 1000;
+    buildPlaylist();
+    std::vector<uint16_t> shuffled = currentPlaylist();
+    anyShuffled |= shuffled != ordered;
+    std::sort(shuffled.begin(), shuffled.end());
+    CHECK(shuffled == ordered);
+  }
+  CHECK(anyShuffled);
+  alarmShuffle = false;
+}
+
+//after a boot random16 always starts with the seed 1337 of FastLED
+static std::vector<uint16_t> firstShuffleAfterBoot(uint32_t uptime){
+  random16_set_seed(1337);
+  host::now = uptime;
+  buildPlaylist();
+  return currentPlaylist();
+}
+
+static void testBootsShuffleDifferently(){
+  alarmFolder = 0;
+  alarmShuffle = true;
+  uint32_t now = host::now;
+  std::vector<uint16_t> first = firstShuffleAfterBoot(5000);
+  std::vector<uint16_t> second = firstShuffleAfterBoot(7130);
+  std::vector<uint16_t> third = firstShuffleAfterBoot(61234);
+  CHECK(first != second);
+  CHECK(second != third);
+  CHECK(first != third);
+  host::now = now;
+  alarmShuffle = false;
+}
+
+static void testAlarmPlaysWithoutQueries(){
+  int queriesBefore = myDFPlayer.queries;
+  myDFPlayer.commands.clear();
+  alarmFolder = 1;
+  playlistLength = 0;
+  playlistPosition = 0;
+  wakeUpProcessStarted = true;
+
+  //the fake is never busy, so every call starts the next song
+  for(int i = 0; i < 6; i++){
+    playNextSongWhenFinished();
+  }
+  CHECK_EQ(myDFPlayer.queries, queriesBefore);
+  CHECK_EQ(myDFPlayer.commands.size(), 6u);
+  CHECK(myDFPlayer.commands[0] == "folder 1/1");
+  CHECK(myDFPlayer.commands[4] == "folder 1/5");
+  //end of the playlist, starts over
+  CHECK(myDFPlayer.commands[5] == "folder 1/1");
+  CHECK_EQ(myDFPlayer.countCommands("next"), 0);
+
+  //a new SD-Card during the alarm is only read afterwards
+  myDFPlayer.files = 30;
+  myDFPlayer.events.push_back(DFPlayerCardInserted);
+  checkDFPlayerCard();
+  CHECK_EQ(myDFPlayer.queries, queriesBefore);
+  CHECK_EQ(trackCount, 20);
+
+  wakeUpProcessStopped = true;
+  controlWakeupSequence();
+  checkDFPlayerCard();
+  CHECK(myDFPlayer.queries > queriesBefore);
+  CHECK_EQ(trackCount, 30);
+  alarmFolder = 0;
+}
+
+static void testMissingIndexFallsBackToNext(){
+  myDFPlayer.events.push_back(DFPlayerCardRemoved);
+  checkDFPlayerCard();
+  CHECK_EQ(trackCount, 0);
+
+  myDFPlayer.commands.clear();
+  wakeUpProcessStarted = true;
+  playNextSongWhenFinished();
+  CHECK_EQ(myDFPlayer.countCommands("next"), 1);
+  wakeUpProcessStarted = false;
+}
+
+int main(){
+  myDFPlayer.files = 20;
+  myDFPlayer.folders = 2;
+  myDFPlayer.folderFiles[1] = 5;
+  myDFPlayer.folderFiles[2] = 7;
+  setupHost();
+
+  testTrackIndexIsReadOnce();
+  testRootPlaylistSkipsSunriseAndCountdown();
+  testFolderPlaylist();
+  testShuffleIsPermutation();
+  testBootsShuffleDifferently();
+  testAlarmPlaysWithoutQueries();
+  testMissingIndexFallsBackToNext();
+  return finishTests("test_playlist");
+}
@@ -0,0 +1,95 @@
+// Master side of the sync: beacons, clock samples and the seeded fire.
+#include "../lichtwecker.cpp"
+#include "harness.h"
+
+#include <set>
+
+static bool lastBeacon(SyncPacket &beacon){
+  for(auto sent = syncUdp.sent.rbegin(); sent != syncUdp.sent.rend(); ++sent){
+    memcpy(&beacon, sent->data.data(), sizeof(beacon));
+    if(sent->multicast && beacon.type == SYNC_BEACON) return true;
+  }
+  return false;
+}
+
+static void testBeaconCarriesStartOfThisAlarm(){
+  host::now = 50000; //a unit that runs for a while
+  for(int i = 0; i < 20; i++) loop();
+  SyncPacket beacon;
+  CHECK(lastBeacon(beacon));
+  CHECK_EQ(beacon.running, 0);
+
+  syncUdp.sent.clear();
+  host::pins[BUTTON_START_PIN] = HIGH;
+  loop();
+  host::pins[BUTTON_START_PIN] = LOW;
+
+  //the beacon of the state change, not one second later
+  CHECK(lastBeacon(beacon));
+  CHECK_EQ(beacon.running, 1);
+  CHECK_EQ(beacon.sequenceStart, sequenceStartTime);
+  CHECK(beacon.sequenceStart > 50000);
+}
+
+static void testAnswersClockSamples(){
+  HostPacket request;
+  SyncPacket packet;
+  memset(&packet, 0, sizeof(packet));
+  packet.magic = SYNC_MAGIC;
+  packet.type = SYNC_REQUEST;
+  packet.t1 = 4242;
+  request.data.assign((uint8_t *)&packet, (uint8_t *)&packet + sizeof(packet));
+  request.ip = IPAddress(192, 168, 1, 20);
+  request.port = 5000;
+  syncUdp.received.push_back(request);
+  syncUdp.sent.clear();
+  controlSync();
+
+  bool answered = false;
+  for(const auto &sent : syncUdp.sent){
+    memcpy(&packet, sent.data.data(), sizeof(packet));
+    if(packet.type != SYNC_RESPONSE) continue;
+    answered = true;
+    CHECK(sent.ip == request.ip);
+    CHECK_EQ(sent.port, 5000);
+    CHECK_EQ(packet.t1, 4242);
+    CHECK_EQ(packet.t2, millis());
+    CHECK_EQ(packet.t3, millis());
+  }
+  CHECK(answered);
+}
+
+/*
+Bottom pixel of every column over consecutive frames. With consecutive seeds
+the heat of a column only grows by a fixed step per frame, so the changes
+from frame to frame take just a few distinct values.
+*/
+static void testFireIsNotASawtooth(){
+  std::set<int> changes;
+  int previous = -1;
+  for(uint32_t frame = 100; frame < 164; frame++){
+    host::now = sequenceStartTime + frame * FPS_DELAY;
+    showFireAnimation();
+    CRGB pixel = leds[0][0];
+    int value = pixel.r + pixel.g + pixel.b;
+    if(previous >= 0) changes.insert(value - previous);
+    previous = value;
+  }
+  CHECK(changes.size() > 20);
+
+  //but the same frame always gets the same flames
+  host::now = sequenceStartTime + 120 * FPS_DELAY;
+  showFireAnimation();
+  CRGB first[NUM_LEDS];
+  memcpy(first, leds[0], sizeof(first));
+  showFireAnimation();
+  CHECK(memcmp(first, leds[0], sizeof(first)) == 0);
+}
+
+int main(){
+  setupHost();
+  testBeaconCarriesStartOfThisAlarm();
+  testAnswersClockSamples();
+  testFireIsNotASawtooth();
+  return finishTests("test_sync_master");
+}
@@ -0,0 +1,173 @@
+// Slave side of the sync over a loopback stand-in for the network. Every
+// packet is delayed by a base latency plus jitter like on WiFi: most packets
+// are fast, every fifth one is held back by up to MAX_JITTER.
+#include "../lichtwecker.cpp"
+#include "harness.h"
+
+#include <random>
+
+int32_t trueOffset = 1234567;        //master clock - slave clock, changes when the master restarts
+IPAddress masterIP(192, 168, 1, 2);
+const uint32_t BASE_LATENCY = 3;
+const uint32_t MAX_JITTER = 40;
+#ifndef JITTER_SEED
+#define JITTER_SEED 7
+#endif
+
+struct Delivery {
+  uint32_t at;    //slave time
+  SyncPacket packet;
+};
+
+static std::vector<Delivery> network;
+static std::mt19937 jitterSource(JITTER_SEED);
+
+static uint32_t latency(){
+  if(jitterSource() % 5 == 0){
+    return BASE_LATENCY + jitterSource() % (MAX_JITTER + 1);
+  }
+  return BASE_LATENCY + jitterSource() % 3;
+}
+
+static uint32_t masterNow(){
+  return host::now + trueOffset;
+}
+
+static void sendToSlave(const SyncPacket &packet, uint32_t at){
+  Delivery delivery = {at, packet};
+  network.push_back(delivery);
+}
+
+static void sendBeacon(bool running, uint32_t sequenceStart){
+  SyncPacket beacon;
+  memset(&beacon, 0, sizeof(beacon));
+  beacon.magic = SYNC_MAGIC;
+  beacon.type = SYNC_BEACON;
+  beacon.running = running;
+  beacon.sequenceStart = sequenceStart;
+  beacon.t3 = masterNow();
+  sendToSlave(beacon, host::now + latency());
+}
+
+//one millisecond of the network, the master and the slave
+static void step(){
+  for(auto delivery = network.begin(); delivery != network.end();){
+    if(delivery->at <= host::now){
+      HostPacket packet;
+      packet.data.assign((uint8_t *)&delivery->packet, (uint8_t *)&delivery->packet + sizeof(SyncPacket));
+      packet.ip = masterIP;
+      packet.port = SYNC_PORT;
+      syncUdp.received.push_back(packet);
+      delivery = network.erase(delivery);
+    } else {
+      ++delivery;
+    }
+  }
+
+  controlSequenceTimeline();
+  controlSync();
+
+  //the master answers every request on arrival
+  for(const auto &sent : syncUdp.sent){
+    SyncPacket request;
+    memcpy(&request, sent.data.data(), sizeof(request));
+    if(request.type != SYNC_REQUEST) continue;
+    uint32_t arrival = host::now + latency();
+    request.type = SYNC_RESPONSE;
+    request.t2 = arrival + trueOffset;
+    request.t3 = request.t2 + 1;
+    sendToSlave(request, arrival + 1 + latency());
+  }
+  syncUdp.sent.clear();
+  host::now++;
+}
+
+static void run(uint32_t ms, bool running, uint32_t sequenceStart){
+  for(uint32_t i = 0; i < ms; i++){
+    if(masterNow() % SYNC_BEACON_INTERVAL == 0) sendBeacon(running, sequenceStart);
+    step();
+  }
+}
+
+static int32_t distance(int64_t a, int64_t b){
+  return a > b ? a - b : b - a;
+}
+
+static void testOffsetIsEstimated(){
+  run(30000, false, 0);
+  CHECK(syncLocked);
+  CHECK(syncMasterKnown);
+  CHECK(distance(syncOffset, trueOffset) <= 3);
+  CHECK(syncRoundTrip <= 2 * BASE_LATENCY + MAX_JITTER);
+  CHECK(!wakeUpProcessStarted);
+}
+
+static void testSlaveFollowsTimelineOfMaster(){
+  uint32_t masterStart = masterNow();
+  run(2500, true, masterStart); //between two steps of the sun
+  CHECK(wakeUpProcessStarted);
+  CHECK(distance(sequenceMillis(), masterNow() - masterStart) <= 3);
+
+  //the sun of the slave is where the sun of the master is
+  showSunrise();
+  CHECK(!sunriseEndPositionReached);
+  CHECK_EQ(sunposition, -6 + (int)((masterNow() - masterStart) / SUNRISE_STEP_DELAY));
+
+  run(2000, false, masterStart);
+  controlWakeupSequence();
+  CHECK(!wakeUpProcessStarted);
+}
+
+/*
+The estimate may be a few Miliseconds too low. Right after the start of the
+master the start then still lies ahead, which must not look like the end of
+the timeline: full brightness and a risen sun in the first frame.
+*/
+static void testStartAheadOfEstimateIsZero(){
+  int32_t estimate = syncOffset;
+  syncOffset = trueOffset - 5;
+  syncSequenceStart = masterNow() - 2;
+  syncMasterRunning = true;
+  wakeUpProcessStarted = true;
+  controlSequenceTimeline();
+  CHECK_EQ(sequenceMillis(), 0);
+
+  controlFade();
+  CHECK_EQ(FastLED.getBrightness(), BRIGHTNESS_START);
+  CHECK_EQ(fadeVolume, VOLUME_START);
+  showSunrise();
+  CHECK(!sunriseEndPositionReached);
+  CHECK_EQ(sunposition, -6);
+
+  syncMasterRunning = false;
+  stopWakeUpProcess();
+  syncOffset = estimate;
+}
+
+//samples of another master or of the master before its restart are dropped
+static void testNewMasterIsSampledAgain(){
+  masterIP = IPAddress(192, 168, 1, 3);
+  run(SYNC_BEACON_INTERVAL, false, 0);
+  CHECK(syncMasterIP == masterIP);
+  run(30000, false, 0);
+  CHECK(syncLocked);
+  CHECK(distance(syncOffset, trueOffset) <= 3);
+
+  //restarted, the clock of the master begins at 0 again
+  trueOffset = 500 - (int32_t)host::now;
+  run(SYNC_BEACON_INTERVAL, false, 0);
+  CHECK(syncSampleCount <= 1);
+  run(5000, false, 0);
+  CHECK(syncLocked);
+  CHECK(distance(syncOffset, trueOffset) <= 3);
+}
+
+int main(){
+  setupHost();
+  host::now = 1000;
+  testOffsetIsEstimated();
+  testSlaveFollowsTimelineOfMaster();
+  testStartAheadOfEstimateIsZero();
+  testNewMasterIsSampledAgain();
+  return finishTests("test_sync_slave");
+}